@@ -0,0 +1,813 @@
+#include "dense_flat_hash_map.hpp"
+#include "flat_unordered_hash_map.hpp"
+#include "flat_unordered_hash_set.hpp"
+#include "frozen_flat_hash_map.hpp"
+#include "left_right_flat_hash_map.hpp"
+#include "mapped_flat_hash_map.hpp"
+#include "node_unordered_hash_map.hpp"
+#include "sharded_flat_hash_map.hpp"
+#include "split_flat_unordered_hash_map.hpp"
+
+#include "perf_counters.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// benchmark suite comparing the maps of this repository against std::unordered_map
+//   - key types: u64, short strings (fit in the small string buffer) and long strings (heap allocated, common prefix)
+//   - working sets from the l1 data cache up to 10x the last level cache
+//   - workloads of the mutable maps and the set: insert (with and without reserve), lookups at several hit ratios,
+//     erase churn, iteration, rebuild (reserve on a full map), copy and merge
+//   - workloads of the read only maps (frozen, mapped): build from a full map and lookups at several hit ratios
+//   - workloads of the concurrent maps (sharded, left-right): lookups, and lookups mixed with assignments, from every thread at once
+// results are printed to stdout as json, progress goes to stderr
+// usage: flat_hash_map_bench [--quick] [--perf] [--filter=<substring of map/key/workload>] [--max-working-set=<bytes>] [--threads=<count>]
+
+namespace
+{
+    using namespace Kablunk::util::container;
+
+    using value_t = uint64_t;
+
+    // command line options
+    struct options
+    {
+        // only the l1 and l2 working sets, fewer operations per measurement
+        bool quick = false;
+        // read hardware counters around every measurement
+        bool perf = false;
+        // only run benchmarks whose "map/key/workload" name contains this
+        std::string filter;
+        // skip working sets larger than this, 0 for no limit
+        size_t max_working_set_bytes = 0;
+        // threads of the contended workloads, 0 for one per hardware thread
+        size_t thread_count = 0;
+    };
+
+    // data cache sizes of the machine
+    struct cache_sizes
+    {
+        size_t l1d_bytes = 32ull << 10;
+        size_t l2_bytes = 1ull << 20;
+        size_t llc_bytes = 8ull << 20;
+    };
+
+    // result of one measurement
+    struct result
+    {
+        std::string map;
+        std::string key;
+        std::string workload;
+        // share of lookups that hit, negative for workloads that are not lookups
+        double hit_ratio = -1.0;
+        size_t element_count = 0;
+        size_t working_set_bytes = 0;
+        size_t operation_count = 0;
+        double total_ms = 0.0;
+        double ns_per_operation = 0.0;
+        uint64_t checksum = 0;
+        bool has_counters = false;
+        benchmark::perf_counters::sample counters{};
+    };
+
+    // read the data cache sizes from sysfs, the defaults are kept on other platforms
+    cache_sizes detect_cache_sizes()
+    {
+        cache_sizes sizes;
+        for (int index = 0; index < 8; ++index)
+        {
+            const std::string path = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+            std::ifstream level_file{ path + "level" }, type_file{ path + "type" }, size_file{ path + "size" };
+            int level = 0;
+            std::string type, size;
+            if (!(level_file >> level) || !(type_file >> type) || !(size_file >> size) || type == "Instruction")
+                continue;
+
+            // sizes are written like "48K" or "8192K"
+            size_t bytes = std::stoull(size);
+            if (size.back() == 'K')
+                bytes <<= 10;
+            else if (size.back() == 'M')
+                bytes <<= 20;
+
+            if (level == 1)
+                sizes.l1d_bytes = bytes;
+            else if (level == 2)
+                sizes.l2_bytes = bytes;
+
+            sizes.llc_bytes = std::max(sizes.llc_bytes, bytes);
+        }
+
+        return sizes;
+    }
+
+    // =========
+    // key types
+    // =========
+
+    // keys are generated from an index, so hit keys are [0, n) and miss keys [n, 2n) with no overlap
+    struct u64_keys
+    {
+        using key_t = uint64_t;
+        static constexpr const char* s_name = "u64";
+
+        // odd multiplier so the keys are distinct but not sequential
+        static key_t make(const size_t index) { return (index + 1) * 0x9E3779B97F4A7C15ull; }
+        static size_t get_heap_bytes(const key_t&) { return 0; }
+    };
+
+    struct short_string_keys
+    {
+        using key_t = std::string;
+        static constexpr const char* s_name = "short_string";
+
+        // at most 12 characters, stored in the small string buffer
+        static key_t make(const size_t index) { return "k:" + std::to_string(index); }
+        static size_t get_heap_bytes(const key_t&) { return 0; }
+    };
+
+    struct long_string_keys
+    {
+        using key_t = std::string;
+        static constexpr const char* s_name = "long_string";
+
+        // long common prefix, so keys only differ near their end
+        static key_t make(const size_t index) { return "tenant:0042/session:user:profile:preferences:" + std::to_string(index); }
+        static size_t get_heap_bytes(const key_t& key) { return key.capacity() + 1; }
+    };
+
+    // ============
+    // map adapters
+    // ============
+
+    // sum of the values of a map, read by iterating over its pairs
+    template <typename map_t>
+    uint64_t sum_pair_values(const map_t& map)
+    {
+        uint64_t sum = 0;
+        for (auto&& [key, value] : map)
+            sum += value;
+
+        return sum;
+    }
+
+    // uniform interface over the maps, the maps of this repository share most of their api
+    template <typename map_t>
+    struct map_adapter
+    {
+        template <typename key_t>
+        static void insert(map_t& map, const key_t& key, const value_t value) { map.insert(key, value); }
+        template <typename key_t>
+        static bool contains(const map_t& map, const key_t& key) { return map.contains(key); }
+        template <typename key_t>
+        static void erase(map_t& map, const key_t& key) { map.erase(key); }
+        static void reserve(map_t& map, const size_t size) { map.reserve(size); }
+        // copy every pair of source into destination
+        static void merge(map_t& destination, const map_t& source)
+        {
+            source.for_each([&destination](const auto& pair) { destination.insert(pair.key, pair.value); });
+        }
+        // iterate over every pair
+        static uint64_t sum_values(const map_t& map) { return sum_pair_values(map); }
+    };
+
+    // also matches small_flat_unordered_hash_map, which only differs in its inline capacity
+    template <typename K, bool StoreHash, size_t InlineCapacity>
+    struct map_adapter<flat_unordered_hash_map<K, value_t, hash::hasher<K>, hash::key_equal<K>, std::allocator<details::hash_map_pair<K, value_t>>, StoreHash, InlineCapacity>>
+    {
+        using map_t = flat_unordered_hash_map<K, value_t, hash::hasher<K>, hash::key_equal<K>, std::allocator<details::hash_map_pair<K, value_t>>, StoreHash, InlineCapacity>;
+
+        static void insert(map_t& map, const K& key, const value_t value) { map.insert(key, value); }
+        static bool contains(const map_t& map, const K& key) { return map.contains(key); }
+        static void erase(map_t& map, const K& key) { map.erase(key); }
+        static void reserve(map_t& map, const size_t size) { map.reserve(size); }
+        static void merge(map_t& destination, const map_t& source) { destination.merge(source); }
+        static uint64_t sum_values(const map_t& map) { return sum_pair_values(map); }
+    };
+
+    // the set stores keys only, values are dropped on insert
+    template <typename K>
+    struct map_adapter<flat_unordered_hash_set<K>>
+    {
+        using map_t = flat_unordered_hash_set<K>;
+
+        static void insert(map_t& map, const K& key, const value_t) { map.insert(key); }
+        static bool contains(const map_t& map, const K& key) { return map.contains(key); }
+        static void erase(map_t& map, const K& key) { map.erase(key); }
+        static void reserve(map_t& map, const size_t size) { map.reserve(size); }
+        static void merge(map_t& destination, const map_t& source) { destination.insert_range(source); }
+        // without values the key count is summed instead
+        static uint64_t sum_values(const map_t& map)
+        {
+            uint64_t count = 0;
+            for (const K& key : map)
+                count += !key_is_empty(key);
+
+            return count;
+        }
+    private:
+        // touches the key, so iteration is not optimized into a size() call
+        static bool key_is_empty(const uint64_t key) { return key == 0; }
+        static bool key_is_empty(const std::string& key) { return key.empty(); }
+    };
+
+    template <typename K>
+    struct map_adapter<std::unordered_map<K, value_t>>
+    {
+        using map_t = std::unordered_map<K, value_t>;
+
+        static void insert(map_t& map, const K& key, const value_t value) { map.emplace(key, value); }
+        static bool contains(const map_t& map, const K& key) { return map.find(key) != map.end(); }
+        static void erase(map_t& map, const K& key) { map.erase(key); }
+        static void reserve(map_t& map, const size_t size) { map.reserve(size); }
+        // copies like flat_unordered_hash_map::merge, std::unordered_map::merge would steal the nodes instead
+        static void merge(map_t& destination, const map_t& source) { destination.insert(source.begin(), source.end()); }
+        static uint64_t sum_values(const map_t& map) { return sum_pair_values(map); }
+    };
+
+    // ======
+    // runner
+    // ======
+
+    // times the measured sections of a workload, and counts hardware events over exactly the same sections
+    class stopwatch
+    {
+    public:
+        explicit stopwatch(benchmark::perf_counters* counters)
+            : m_counters{ counters }
+        {
+            if (m_counters)
+                m_counters->reset();
+        }
+
+        // measure the call of a function
+        template <typename function_t>
+        inline void measure(function_t&& function)
+        {
+            if (m_counters)
+                m_counters->start();
+
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            m_elapsed += std::chrono::steady_clock::now() - start;
+
+            if (m_counters)
+                m_counters->stop();
+        }
+
+        // total time of every measured section, in milliseconds
+        inline double get_elapsed_ms() const { return std::chrono::duration<double, std::milli>(m_elapsed).count(); }
+    private:
+        benchmark::perf_counters* m_counters;
+        std::chrono::steady_clock::duration m_elapsed{};
+    };
+
+    // measurement loop and keys shared by the runners below
+    template <typename key_traits_t>
+    class runner_base
+    {
+    public:
+        using key_t = typename key_traits_t::key_t;
+    public:
+        runner_base(const char* map_name, const size_t element_count, const size_t working_set_bytes, const size_t target_operation_count,
+            const options& opts, benchmark::perf_counters* counters, std::vector<result>& results)
+            : m_map_name{ map_name }, m_element_count{ element_count }, m_working_set_bytes{ working_set_bytes },
+            m_round_count{ std::max<size_t>(1, target_operation_count / element_count) }, m_options{ opts }, m_counters{ counters },
+            m_results{ results }
+        {
+            m_keys.reserve(element_count * 2);
+            for (size_t i = 0; i < element_count * 2; ++i)
+                m_keys.push_back(key_traits_t::make(i));
+        }
+    protected:
+        // run a workload for every round and record the result
+        // workload(watch) measures its timed section with watch and returns { operations, checksum }
+        template <typename workload_t>
+        void run_workload(const char* workload_name, const double hit_ratio, workload_t&& workload)
+        {
+            const std::string name = std::string{ m_map_name } + "/" + key_traits_t::s_name + "/" + workload_name;
+            if (!m_options.filter.empty() && name.find(m_options.filter) == std::string::npos)
+                return;
+
+            std::cerr << name << " " << m_element_count << (hit_ratio >= 0.0 ? " hit " + std::to_string(hit_ratio) : "") << std::endl;
+
+            stopwatch watch{ m_counters };
+            size_t operation_count = 0;
+            uint64_t checksum = 0;
+            for (size_t round = 0; round < m_round_count; ++round)
+            {
+                const auto [operations, round_checksum] = workload(watch);
+                operation_count += operations;
+                checksum += round_checksum;
+            }
+
+            result entry;
+            entry.map = m_map_name;
+            entry.key = key_traits_t::s_name;
+            entry.workload = workload_name;
+            entry.hit_ratio = hit_ratio;
+            entry.element_count = m_element_count;
+            entry.working_set_bytes = m_working_set_bytes;
+            entry.operation_count = operation_count;
+            entry.total_ms = watch.get_elapsed_ms();
+            entry.ns_per_operation = entry.total_ms * 1e6 / static_cast<double>(std::max<size_t>(1, operation_count));
+            entry.checksum = checksum;
+            entry.has_counters = m_counters != nullptr;
+            if (m_counters)
+                entry.counters = m_counters->read();
+
+            m_results.push_back(std::move(entry));
+        }
+
+        // keys in random order, hit_ratio of them are among the first element_count keys
+        std::vector<const key_t*> make_lookups(const double hit_ratio)
+        {
+            std::vector<const key_t*> lookups(m_element_count);
+            const size_t hit_count = static_cast<size_t>(hit_ratio * static_cast<double>(m_element_count));
+            for (size_t i = 0; i < m_element_count; ++i)
+                lookups[i] = &m_keys[i < hit_count ? i : m_element_count + i];
+            std::shuffle(lookups.begin(), lookups.end(), m_random);
+
+            return lookups;
+        }
+    protected:
+        const char* m_map_name;
+        size_t m_element_count;
+        size_t m_working_set_bytes;
+        // measurements repeat the workload until about target_operation_count operations ran
+        size_t m_round_count;
+        const options& m_options;
+        benchmark::perf_counters* m_counters;
+        std::vector<result>& m_results;
+        // hit keys followed by miss keys
+        std::vector<key_t> m_keys;
+        std::mt19937_64 m_random{ 42 };
+    };
+
+    // runs every workload of one map over one key type and working set
+    template <typename map_t, typename key_traits_t>
+    class workload_runner : private runner_base<key_traits_t>
+    {
+    public:
+        using base_t = runner_base<key_traits_t>;
+        using key_t = typename base_t::key_t;
+        using adapter_t = map_adapter<map_t>;
+    public:
+        using base_t::base_t;
+
+        void run()
+        {
+            this->run_workload("insert", -1.0, [this](stopwatch& watch) { return insert(watch, false); });
+            this->run_workload("insert_reserved", -1.0, [this](stopwatch& watch) { return insert(watch, true); });
+            for (const double hit_ratio : { 1.0, 0.5, 0.0 })
+                this->run_workload("find", hit_ratio, [this, hit_ratio](stopwatch& watch) { return find(watch, hit_ratio); });
+            this->run_workload("erase_churn", -1.0, [this](stopwatch& watch) { return erase_churn(watch); });
+            this->run_workload("iterate", -1.0, [this](stopwatch& watch) { return iterate(watch); });
+            this->run_workload("rebuild", -1.0, [this](stopwatch& watch) { return rebuild(watch); });
+            this->run_workload("copy", -1.0, [this](stopwatch& watch) { return copy(watch); });
+            this->run_workload("merge", -1.0, [this](stopwatch& watch) { return merge(watch); });
+        }
+    private:
+        // map with the first element_count keys
+        map_t make_filled_map(const size_t first = 0) const
+        {
+            map_t map;
+            for (size_t i = first; i < first + this->m_element_count; ++i)
+                adapter_t::insert(map, this->m_keys[i], static_cast<value_t>(i));
+
+            return map;
+        }
+
+        std::pair<size_t, uint64_t> insert(stopwatch& watch, const bool reserve)
+        {
+            map_t map;
+            if (reserve)
+                adapter_t::reserve(map, this->m_element_count);
+
+            watch.measure([&]()
+                {
+                    for (size_t i = 0; i < this->m_element_count; ++i)
+                        adapter_t::insert(map, this->m_keys[i], static_cast<value_t>(i));
+                }
+            );
+
+            return { this->m_element_count, map.size() };
+        }
+
+        // look up keys in random order, hit_ratio of them are in the map
+        std::pair<size_t, uint64_t> find(stopwatch& watch, const double hit_ratio)
+        {
+            const map_t map = make_filled_map();
+            const std::vector<const key_t*> lookups = this->make_lookups(hit_ratio);
+
+            uint64_t found = 0;
+            watch.measure([&]()
+                {
+                    for (const key_t* key : lookups)
+                        found += adapter_t::contains(map, *key);
+                }
+            );
+
+            return { this->m_element_count, found };
+        }
+
+        // erase the oldest key and insert a new one, so the map keeps its size while tombstones pile up
+        std::pair<size_t, uint64_t> erase_churn(stopwatch& watch)
+        {
+            map_t map = make_filled_map();
+
+            watch.measure([&]()
+                {
+                    for (size_t i = 0; i < this->m_element_count; ++i)
+                    {
+                        adapter_t::erase(map, this->m_keys[i]);
+                        adapter_t::insert(map, this->m_keys[this->m_element_count + i], static_cast<value_t>(i));
+                    }
+                }
+            );
+
+            return { this->m_element_count, map.size() };
+        }
+
+        std::pair<size_t, uint64_t> iterate(stopwatch& watch)
+        {
+            const map_t map = make_filled_map();
+
+            uint64_t sum = 0;
+            watch.measure([&]() { sum = adapter_t::sum_values(map); });
+
+            return { this->m_element_count, sum };
+        }
+
+        // reserve far past the current size, so every element is rehashed into a new bucket
+        std::pair<size_t, uint64_t> rebuild(stopwatch& watch)
+        {
+            map_t map = make_filled_map();
+
+            watch.measure([&]() { adapter_t::reserve(map, this->m_element_count * 4); });
+
+            return { this->m_element_count, map.size() };
+        }
+
+        std::pair<size_t, uint64_t> copy(stopwatch& watch)
+        {
+            const map_t map = make_filled_map();
+
+            uint64_t size = 0;
+            watch.measure([&]()
+                {
+                    const map_t copy{ map };
+                    size = copy.size();
+                }
+            );
+
+            return { this->m_element_count, size };
+        }
+
+        // merge a map of element_count new keys into a map of element_count keys
+        std::pair<size_t, uint64_t> merge(stopwatch& watch)
+        {
+            map_t destination = make_filled_map();
+            const map_t source = make_filled_map(this->m_element_count);
+
+            watch.measure([&]() { adapter_t::merge(destination, source); });
+
+            return { this->m_element_count, destination.size() };
+        }
+    };
+
+    // builds a read only map from a full flat_unordered_hash_map
+    template <typename map_t>
+    struct read_only_adapter;
+
+    template <typename K>
+    struct read_only_adapter<frozen_flat_hash_map<K, value_t>>
+    {
+        using map_t = frozen_flat_hash_map<K, value_t>;
+
+        static map_t build(const flat_unordered_hash_map<K, value_t>& source) { return map_t{ source }; }
+    };
+
+    // the snapshot goes through a file in the temporary directory, writing and mapping it are both measured
+    template <typename K>
+    struct read_only_adapter<mapped_flat_unordered_hash_map<K, value_t>>
+    {
+        using map_t = mapped_flat_unordered_hash_map<K, value_t>;
+
+        static map_t build(const flat_unordered_hash_map<K, value_t>& source)
+        {
+            const std::string path = (std::filesystem::temp_directory_path() / "flat_hash_map_bench.snapshot").string();
+            if (!source.save(path.c_str()))
+                std::cerr << "could not write " << path << ", lookups run on an empty snapshot" << std::endl;
+
+            map_t map = map_t::map_file(path.c_str());
+            // the mapping stays valid once the file is unlinked
+            std::filesystem::remove(path);
+            return map;
+        }
+    };
+
+    // runs the build and lookup workloads of one read only map over one key type and working set
+    template <typename map_t, typename key_traits_t>
+    class read_only_runner : private runner_base<key_traits_t>
+    {
+    public:
+        using base_t = runner_base<key_traits_t>;
+        using key_t = typename base_t::key_t;
+        using adapter_t = read_only_adapter<map_t>;
+    public:
+        using base_t::base_t;
+
+        void run()
+        {
+            this->run_workload("build", -1.0, [this](stopwatch& watch) { return build(watch); });
+            for (const double hit_ratio : { 1.0, 0.5, 0.0 })
+                this->run_workload("find", hit_ratio, [this, hit_ratio](stopwatch& watch) { return find(watch, hit_ratio); });
+        }
+    private:
+        // flat_unordered_hash_map with the first element_count keys
+        flat_unordered_hash_map<key_t, value_t> make_source_map() const
+        {
+            flat_unordered_hash_map<key_t, value_t> map;
+            for (size_t i = 0; i < this->m_element_count; ++i)
+                map.insert(this->m_keys[i], static_cast<value_t>(i));
+
+            return map;
+        }
+
+        std::pair<size_t, uint64_t> build(stopwatch& watch)
+        {
+            const flat_unordered_hash_map<key_t, value_t> source = make_source_map();
+
+            uint64_t size = 0;
+            watch.measure([&]()
+                {
+                    const map_t map = adapter_t::build(source);
+                    size = map.size();
+                }
+            );
+
+            return { this->m_element_count, size };
+        }
+
+        // look up keys in random order, hit_ratio of them are in the map
+        std::pair<size_t, uint64_t> find(stopwatch& watch, const double hit_ratio)
+        {
+            const map_t map = adapter_t::build(make_source_map());
+            const std::vector<const key_t*> lookups = this->make_lookups(hit_ratio);
+
+            uint64_t found = 0;
+            watch.measure([&]()
+                {
+                    for (const key_t* key : lookups)
+                        found += map.contains(*key);
+                }
+            );
+
+            return { this->m_element_count, found };
+        }
+    };
+
+    // runs the contended workloads of one concurrent map over one key type and working set
+    // every thread walks the same keys from a different offset, so the threads touch the same shards and pairs at once
+    // hardware counters only count the calling thread, so these workloads are measured without them
+    template <typename map_t, typename key_traits_t>
+    class contended_runner : private runner_base<key_traits_t>
+    {
+    public:
+        using base_t = runner_base<key_traits_t>;
+        using key_t = typename base_t::key_t;
+    public:
+        contended_runner(const char* map_name, const size_t element_count, const size_t working_set_bytes, const size_t target_operation_count,
+            const size_t thread_count, const options& opts, std::vector<result>& results)
+            : base_t{ map_name, element_count, working_set_bytes, target_operation_count / thread_count, opts, nullptr, results },
+            m_thread_count{ thread_count }
+        { }
+
+        void run()
+        {
+            this->run_workload("contended_find", 1.0, [this](stopwatch& watch) { return contended(watch, 0); });
+            // one in eight operations assigns the value of a key that is already in the map, so the size stays the same
+            this->run_workload("contended_mixed", 1.0, [this](stopwatch& watch) { return contended(watch, 8); });
+        }
+    private:
+        // look up every key in the map from every thread, with an assignment every write_interval operations, 0 for none
+        std::pair<size_t, uint64_t> contended(stopwatch& watch, const size_t write_interval)
+        {
+            map_t map;
+            map.reserve(this->m_element_count);
+            for (size_t i = 0; i < this->m_element_count; ++i)
+                map.insert(this->m_keys[i], static_cast<value_t>(i));
+
+            const std::vector<const key_t*> lookups = this->make_lookups(1.0);
+
+            std::atomic<size_t> ready_count{ 0 };
+            std::atomic<bool> is_started{ false };
+            std::atomic<uint64_t> found{ 0 };
+            std::vector<std::thread> threads;
+            threads.reserve(m_thread_count);
+            for (size_t thread_index = 0; thread_index < m_thread_count; ++thread_index)
+                threads.emplace_back([&, thread_index]()
+                    {
+                        // wait until every thread exists, so starting them is not measured
+                        ready_count.fetch_add(1, std::memory_order_acq_rel);
+                        while (!is_started.load(std::memory_order_acquire))
+                            std::this_thread::yield();
+
+                        uint64_t thread_found = 0;
+                        const size_t offset = thread_index * lookups.size() / m_thread_count;
+                        for (size_t i = 0; i < lookups.size(); ++i)
+                        {
+                            const key_t& key = *lookups[(offset + i) % lookups.size()];
+                            if (write_interval && i % write_interval == 0)
+                                map.insert_or_assign(key, static_cast<value_t>(i));
+                            else
+                                thread_found += map.contains(key);
+                        }
+
+                        found.fetch_add(thread_found, std::memory_order_relaxed);
+                    }
+                );
+
+            while (ready_count.load(std::memory_order_acquire) != m_thread_count)
+                std::this_thread::yield();
+
+            watch.measure([&]()
+                {
+                    is_started.store(true, std::memory_order_release);
+                    for (std::thread& thread : threads)
+                        thread.join();
+                }
+            );
+
+            return { lookups.size() * m_thread_count, found.load() };
+        }
+    private:
+        size_t m_thread_count;
+    };
+
+    // approximate bytes of one entry, used to turn a working set into an element count
+    template <typename key_traits_t>
+    size_t get_entry_bytes()
+    {
+        const typename key_traits_t::key_t key = key_traits_t::make(1ull << 40);
+        return sizeof(details::hash_map_pair<typename key_traits_t::key_t, value_t>) + 1 + key_traits_t::get_heap_bytes(key);
+    }
+
+    // passes a map type to a generic lambda
+    template <typename T>
+    struct type_tag { using type = T; };
+
+    // run every map over one key type and working set
+    template <typename key_traits_t>
+    void run_key_type(const size_t working_set_bytes, const size_t target_operation_count, const size_t thread_count, const options& opts,
+        benchmark::perf_counters* counters, std::vector<result>& results)
+    {
+        using key_t = typename key_traits_t::key_t;
+
+        const size_t element_count = std::max<size_t>(16, working_set_bytes / get_entry_bytes<key_traits_t>());
+        const auto run_map = [&](auto map_tag, const char* map_name)
+        {
+            using map_t = typename decltype(map_tag)::type;
+            workload_runner<map_t, key_traits_t>{ map_name, element_count, working_set_bytes, target_operation_count, opts, counters, results }.run();
+        };
+        const auto run_read_only_map = [&](auto map_tag, const char* map_name)
+        {
+            using map_t = typename decltype(map_tag)::type;
+            read_only_runner<map_t, key_traits_t>{ map_name, element_count, working_set_bytes, target_operation_count, opts, counters, results }.run();
+        };
+        const auto run_concurrent_map = [&](auto map_tag, const char* map_name)
+        {
+            using map_t = typename decltype(map_tag)::type;
+            contended_runner<map_t, key_traits_t>{ map_name, element_count, working_set_bytes, target_operation_count, thread_count, opts, results }.run();
+        };
+
+        run_map(type_tag<std::unordered_map<key_t, value_t>>{}, "std_unordered_map");
+        run_map(type_tag<flat_unordered_hash_map<key_t, value_t>>{}, "flat_unordered_hash_map");
+        // past its inline capacity the small map allocates like flat_unordered_hash_map, the working sets here are all larger
+        run_map(type_tag<small_flat_unordered_hash_map<key_t, value_t, 16>>{}, "small_flat_unordered_hash_map");
+        run_map(type_tag<node_unordered_hash_map<key_t, value_t>>{}, "node_unordered_hash_map");
+        run_map(type_tag<split_flat_unordered_hash_map<key_t, value_t>>{}, "split_flat_unordered_hash_map");
+        run_map(type_tag<dense_flat_hash_map<key_t, value_t>>{}, "dense_flat_hash_map");
+        run_map(type_tag<flat_unordered_hash_set<key_t>>{}, "flat_unordered_hash_set");
+
+        run_read_only_map(type_tag<frozen_flat_hash_map<key_t, value_t>>{}, "frozen_flat_hash_map");
+        run_read_only_map(type_tag<mapped_flat_unordered_hash_map<key_t, value_t>>{}, "mapped_flat_unordered_hash_map");
+
+        run_concurrent_map(type_tag<sharded_flat_hash_map<key_t, value_t>>{}, "sharded_flat_hash_map");
+        run_concurrent_map(type_tag<left_right_flat_hash_map<key_t, value_t>>{}, "left_right_flat_hash_map");
+    }
+
+    // name of the simd backend the maps were compiled with
+    const char* get_simd_name()
+    {
+#if KB_FLAT_HASH_MAP_SIMD == KB_FLAT_HASH_MAP_SIMD_AVX2
+        return "avx2";
+#elif KB_FLAT_HASH_MAP_SIMD == KB_FLAT_HASH_MAP_SIMD_SSE2
+        return "sse2";
+#else
+        return "portable";
+#endif
+    }
+
+    void print_json(const cache_sizes& caches, const bool has_counters, const size_t thread_count, const std::vector<result>& results)
+    {
+        std::printf("{\n  \"machine\": { \"l1d_bytes\": %zu, \"l2_bytes\": %zu, \"llc_bytes\": %zu, \"simd\": \"%s\", \"group_width\": %zu, \"perf_counters\": %s, \"contended_threads\": %zu },\n",
+            caches.l1d_bytes, caches.l2_bytes, caches.llc_bytes, get_simd_name(), details::metadata_group::s_width, has_counters ? "true" : "false", thread_count);
+        std::printf("  \"results\": [\n");
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const result& entry = results[i];
+            std::printf("    { \"map\": \"%s\", \"key\": \"%s\", \"workload\": \"%s\", ", entry.map.c_str(), entry.key.c_str(), entry.workload.c_str());
+            if (entry.hit_ratio >= 0.0)
+                std::printf("\"hit_ratio\": %.2f, ", entry.hit_ratio);
+            else
+                std::printf("\"hit_ratio\": null, ");
+            std::printf("\"elements\": %zu, \"working_set_bytes\": %zu, \"operations\": %zu, \"total_ms\": %.3f, \"ns_per_op\": %.3f, \"checksum\": %llu",
+                entry.element_count, entry.working_set_bytes, entry.operation_count, entry.total_ms, entry.ns_per_operation,
+                static_cast<unsigned long long>(entry.checksum));
+            if (entry.has_counters)
+            {
+                const double operation_count = static_cast<double>(std::max<size_t>(1, entry.operation_count));
+                std::printf(", \"cache_misses_per_op\": %.4f, \"branch_misses_per_op\": %.4f",
+                    static_cast<double>(entry.counters.cache_misses) / operation_count, static_cast<double>(entry.counters.branch_misses) / operation_count);
+            }
+            std::printf(" }%s\n", i + 1 < results.size() ? "," : "");
+        }
+        std::printf("  ]\n}\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    options opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--quick")
+            opts.quick = true;
+        else if (argument == "--perf")
+            opts.perf = true;
+        else if (argument.rfind("--filter=", 0) == 0)
+            opts.filter = argument.substr(9);
+        else if (argument.rfind("--max-working-set=", 0) == 0)
+            opts.max_working_set_bytes = std::stoull(argument.substr(18));
+        else if (argument.rfind("--threads=", 0) == 0)
+            opts.thread_count = std::stoull(argument.substr(10));
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--quick] [--perf] [--filter=<substring>] [--max-working-set=<bytes>] [--threads=<count>]" << std::endl;
+            return 1;
+        }
+    }
+
+    const cache_sizes caches = detect_cache_sizes();
+
+    benchmark::perf_counters counters;
+    benchmark::perf_counters* counters_ptr = nullptr;
+    if (opts.perf)
+    {
+        if (counters.open())
+            counters_ptr = &counters;
+        else
+            std::cerr << "perf_event_open is unavailable, running without hardware counters" << std::endl;
+    }
+
+    // half of each cache leaves room for the keys being looked up and the rest of the process
+    std::vector<size_t> working_sets = { caches.l1d_bytes / 2, caches.l2_bytes / 2 };
+    if (!opts.quick)
+    {
+        working_sets.push_back(caches.llc_bytes / 2);
+        working_sets.push_back(caches.llc_bytes * 10);
+    }
+
+    const size_t target_operation_count = opts.quick ? 200'000ull : 2'000'000ull;
+    // at least two threads, so the contended workloads contend even on a single core
+    const size_t thread_count = std::max<size_t>(2, opts.thread_count ? opts.thread_count : std::thread::hardware_concurrency());
+
+    std::vector<result> results;
+    for (const size_t working_set_bytes : working_sets)
+    {
+        if (opts.max_working_set_bytes && working_set_bytes > opts.max_working_set_bytes)
+            continue;
+
+        run_key_type<u64_keys>(working_set_bytes, target_operation_count, thread_count, opts, counters_ptr, results);
+        run_key_type<short_string_keys>(working_set_bytes, target_operation_count, thread_count, opts, counters_ptr, results);
+        run_key_type<long_string_keys>(working_set_bytes, target_operation_count, thread_count, opts, counters_ptr, results);
+    }
+
+    print_json(caches, counters_ptr != nullptr, thread_count, results);
+
+    return 0;
+}
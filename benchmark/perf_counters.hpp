@@ -0,0 +1,134 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_BENCHMARK_PERF_COUNTERS_HPP
+#define KABLUNK_UTILITIES_CONTAINER_BENCHMARK_PERF_COUNTERS_HPP
+
+#include <stdint.h>
+
+#if defined(__linux__)
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+namespace Kablunk::util::container::benchmark
+{ // start namespace Kablunk::util::container::benchmark
+
+	// hardware counters of the calling thread, read with perf_event_open
+	// cache and branch misses are opened as one group so both count over exactly the same instructions
+	// only user space is counted, which works with the default perf_event_paranoid level of 2
+	// on other platforms, or when the kernel refuses (containers, missing pmu), open() fails and samples stay zero
+	class perf_counters
+	{
+	public:
+		// counter values accumulated between start() and stop() calls
+		struct sample
+		{
+			uint64_t cache_misses = 0;
+			uint64_t branch_misses = 0;
+		};
+	public:
+		perf_counters() = default;
+		perf_counters(const perf_counters&) = delete;
+		~perf_counters() { close(); }
+
+		perf_counters& operator=(const perf_counters&) = delete;
+
+		// open the counters, returns whether they are available
+		bool open()
+		{
+#if defined(__linux__)
+			m_group_fd = open_counter(PERF_COUNT_HW_CACHE_MISSES, -1);
+			if (m_group_fd >= 0)
+				m_branch_fd = open_counter(PERF_COUNT_HW_BRANCH_MISSES, m_group_fd);
+
+			if (m_group_fd < 0 || m_branch_fd < 0)
+				close();
+#endif
+			return is_available();
+		}
+		// whether the counters were opened
+		inline bool is_available() const { return m_group_fd >= 0; }
+		// zero the counters
+		inline void reset()
+		{
+#if defined(__linux__)
+			if (is_available())
+				ioctl(m_group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+#endif
+		}
+		// start counting
+		inline void start()
+		{
+#if defined(__linux__)
+			if (is_available())
+				ioctl(m_group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+		}
+		// stop counting, the counts so far are kept
+		inline void stop()
+		{
+#if defined(__linux__)
+			if (is_available())
+				ioctl(m_group_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+		}
+		// counts accumulated since the last reset
+		sample read() const
+		{
+			sample result{};
+#if defined(__linux__)
+			// PERF_FORMAT_GROUP layout, the number of counters followed by their values in opening order
+			struct group_read_format
+			{
+				uint64_t counter_count;
+				uint64_t values[2];
+			} counts{};
+
+			if (is_available() && ::read(m_group_fd, &counts, sizeof(counts)) == static_cast<ssize_t>(sizeof(counts)))
+			{
+				result.cache_misses = counts.values[0];
+				result.branch_misses = counts.values[1];
+			}
+#endif
+			return result;
+		}
+	private:
+#if defined(__linux__)
+		// open a disabled hardware counter, group_fd of -1 makes it a group leader
+		static int open_counter(const uint64_t config, const int group_fd)
+		{
+			perf_event_attr attributes{};
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.size = sizeof(perf_event_attr);
+			attributes.config = config;
+			attributes.disabled = group_fd < 0;
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			attributes.read_format = PERF_FORMAT_GROUP;
+
+			return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group_fd, 0));
+		}
+#endif
+		// close any counter that was opened
+		void close()
+		{
+#if defined(__linux__)
+			if (m_branch_fd >= 0)
+				::close(m_branch_fd);
+			if (m_group_fd >= 0)
+				::close(m_group_fd);
+#endif
+			m_branch_fd = -1;
+			m_group_fd = -1;
+		}
+	private:
+		// group leader, counts cache misses
+		int m_group_fd = -1;
+		// counts branch misses
+		int m_branch_fd = -1;
+	};
+
+} // end namespace Kablunk::util::container::benchmark
+
+#endif
@@ -0,0 +1,584 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_DENSE_FLAT_HASH_MAP_HPP
+#define KABLUNK_UTILITIES_CONTAINER_DENSE_FLAT_HASH_MAP_HPP
+
+#include "flat_unordered_hash_map.hpp"
+
+namespace Kablunk::util::container
+{ // start namespace Kablunk::util::container
+
+// unordered hash map whose pairs are packed into one contiguous array
+// a swiss table of control bytes and 4 byte indices points into the pair array, so
+//   - iteration is a linear scan over exactly size() pairs, and the pairs can be handed out as a span
+//   - rehashing only rewrites control bytes and indices, pairs are never moved by a rehash
+//   - pairs are kept in insertion order until the first erase, erasing moves the last pair into the hole
+// the cost is an extra indirection on every key compare, and keys are rehashed (not stored) when the index table grows
+// prefer it over flat_unordered_hash_map when the map is iterated far more often than it is looked up
+template <
+	typename K,
+	typename V,
+	typename Hash = hash::hasher<K>,
+	typename KeyEqual = hash::key_equal<K>,
+	typename Allocator = std::allocator<details::hash_map_pair<K, V>>
+>
+class dense_flat_hash_map
+{
+public:
+	using key_t = K;
+	using value_t = V;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using allocator_t = Allocator;
+	using hash_map_pair_t = details::hash_map_pair<key_t, value_t>;
+	using hash_t = uint64_t;
+	using index_t = uint32_t;
+	using metadata_t = details::swiss_table_metadata;
+	using group_t = details::metadata_group;
+	using mask_t = typename group_t::mask_t;
+	using probe_sequence_t = details::probe_sequence<group_t::s_width>;
+	using h2_t = uint8_t;
+	// allocator used for the pair array
+	using pair_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<hash_map_pair_t>;
+	// allocator used for the combined control byte and index block
+	using block_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<details::cache_line>;
+	using block_allocator_traits_t = std::allocator_traits<block_allocator_t>;
+	// iteration walks the pair array directly
+	using iterator = hash_map_pair_t*;
+	using citerator = const hash_map_pair_t*;
+public:
+	// default constructor, allocates nothing until the first insertion
+	dense_flat_hash_map() = default;
+	// constructor with a custom allocator
+	explicit dense_flat_hash_map(const allocator_t& allocator)
+		: m_pairs{ pair_allocator_t{ allocator } }, m_allocator{ allocator }
+	{ }
+	// constructor with a custom hash, key equality function, and allocator
+	explicit dense_flat_hash_map(const hasher_t& hasher, const key_equal_t& key_equal = key_equal_t{}, const allocator_t& allocator = allocator_t{})
+		: m_pairs{ pair_allocator_t{ allocator } }, m_hasher{ hasher }, m_key_equal{ key_equal }, m_allocator{ allocator }
+	{ }
+	// copy constructor, the index table is copied as is since indices do not depend on addresses
+	dense_flat_hash_map(const dense_flat_hash_map& other);
+	// move constructor
+	dense_flat_hash_map(dense_flat_hash_map&& other) noexcept;
+	// destructor
+	~dense_flat_hash_map() { deallocate_table(); }
+
+	// copy assign operator
+	dense_flat_hash_map& operator=(const dense_flat_hash_map& other);
+	// move assign operator
+	dense_flat_hash_map& operator=(dense_flat_hash_map&& other) noexcept;
+
+	// ========
+	// capacity
+	// ========
+
+	// check whether the map is empty
+	inline bool empty() const { return m_pairs.empty(); }
+	// returns the number of key-value pairs in the map
+	inline size_t size() const { return m_pairs.size(); }
+	// returns the number of slots in the index table, 0 until the first insertion
+	inline size_t max_size() const { return m_capacity; }
+	// returns the number of bytes allocated for the index table and the pair array
+	inline size_t get_allocated_bytes() const
+	{
+		return sizeof(details::cache_line) * get_table_line_count(m_capacity) + sizeof(hash_map_pair_t) * m_pairs.capacity();
+	}
+	// returns a copy of the allocator used by the map
+	inline allocator_t get_allocator() const { return allocator_t{ m_allocator }; }
+	// returns a copy of the hash function used by the map
+	inline hasher_t get_hasher() const { return m_hasher; }
+	// returns a copy of the key equality function used by the map
+	inline key_equal_t get_key_equal() const { return m_key_equal; }
+
+	// =========
+	// modifiers
+	// =========
+
+	// destroy every pair and free memory
+	void clear();
+	// insert a pair, *safely* fails if the key is already present
+	inline void insert(const hash_map_pair_t& pair) { try_emplace(pair.key, pair.value); }
+	// insert a pair, *safely* fails if the key is already present
+	inline void insert(hash_map_pair_t&& pair) { try_emplace(std::move(pair.key), std::move(pair.value)); }
+	// insert a pair via key and value, *safely* fails if the key is already present
+	inline void insert(const key_t& key, const value_t& value) { try_emplace(key, value); }
+	// insert a pair, the value of an existing key is replaced
+	void emplace(key_t&& key, value_t&& value);
+	// construct a value in-place if the key does not exist, returns the pair of the key either way
+	// the reference is invalidated by any later insertion or erasure
+	template <typename key_arg_t, typename... Args>
+	hash_map_pair_t& try_emplace(key_arg_t&& key, Args&&... args);
+	// erase a pair, the last pair is moved into its place
+	void erase(const key_t& key);
+	// erase the pair an iterator points to, returns an iterator to the pair moved into its place (or end())
+	iterator erase(citerator it);
+	// swap the contents
+	void swap(dense_flat_hash_map& other);
+	// reserve room for *at least* new_size pairs, the index table is rounded up to the next power of two
+	void reserve(const size_t new_size);
+
+	// ======
+	// lookup
+	// ======
+
+	// access a specific element with bounds checking
+	value_t& at(const key_t& key);
+	// access a specific element with bounds checking
+	const value_t& at(const key_t& key) const;
+	// access or insert (default construct) a specific element
+	inline value_t& operator[](const key_t& key) { return try_emplace(key).value; }
+	// finds the element with a certain key
+	inline iterator find(const key_t& key) { const size_t slot = find_slot_of(key, hash_key(key)); return slot == s_npos ? end() : begin() + m_indices[slot]; }
+	// finds the element with a certain key
+	inline citerator find(const key_t& key) const { const size_t slot = find_slot_of(key, hash_key(key)); return slot == s_npos ? end() : begin() + m_indices[slot]; }
+	// check if a key is contained within the map
+	inline bool contains(const key_t& key) const { return find_slot_of(key, hash_key(key)) != s_npos; }
+
+	// =========
+	// iterators
+	// =========
+
+	// iterator pointing to the first pair
+	inline iterator begin() { return m_pairs.data(); }
+	// iterator pointing past the last pair
+	inline iterator end() { return m_pairs.data() + m_pairs.size(); }
+	// const iterator pointing to the first pair
+	inline citerator begin() const { return m_pairs.data(); }
+	// const iterator pointing past the last pair
+	inline citerator end() const { return m_pairs.data() + m_pairs.size(); }
+	// const iterator pointing to the first pair
+	inline citerator cbegin() const { return begin(); }
+	// const iterator pointing past the last pair
+	inline citerator cend() const { return end(); }
+	// pointer to the packed pairs, valid until the next insertion or erasure
+	inline hash_map_pair_t* data() { return m_pairs.data(); }
+	// pointer to the packed pairs, valid until the next insertion or erasure
+	inline const hash_map_pair_t* data() const { return m_pairs.data(); }
+	// call function(hash_map_pair_t&) on every pair in the map, in storage order
+	template <typename function_t>
+	inline void for_each(function_t&& function) { for (hash_map_pair_t& pair : m_pairs) function(pair); }
+	// call function(const hash_map_pair_t&) on every pair in the map, in storage order
+	template <typename function_t>
+	inline void for_each(function_t&& function) const { for (const hash_map_pair_t& pair : m_pairs) function(pair); }
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+	// the packed pairs, keys must not be modified through the span
+	inline std::span<hash_map_pair_t> get_pairs() { return { m_pairs.data(), m_pairs.size() }; }
+	// the packed pairs
+	inline std::span<const hash_map_pair_t> get_pairs() const { return { m_pairs.data(), m_pairs.size() }; }
+#endif
+private:
+	// hash a key with the map's hasher
+	inline hash_t hash_key(const key_t& key) const { return static_cast<hash_t>(m_hasher(key)); }
+	// number of pairs the index table holds before it is rebuilt
+	inline size_t get_max_load() const { return m_capacity - m_capacity / 8; }
+	// slot of the index table that refers to a key, s_npos if the key is missing
+	inline size_t find_slot_of(const key_t& key, const hash_t hash_value) const;
+	// slot of the index table that refers to a pair index, the pair must be in the map
+	inline size_t find_slot_of_index(const hash_t hash_value, const index_t index) const;
+	// first empty or deleted slot in the probe sequence of a hash
+	inline size_t find_insert_slot_of(const hash_t hash_value) const;
+	// slot of an existing key, or a free slot for it, rebuilding the index table first if it is full
+	inline size_t find_or_prepare_insert(const key_t& key, const hash_t hash_value, bool& found);
+	// point a free slot at the pair index, a reused deleted slot stops counting as a tombstone
+	inline void set_slot(const size_t slot, const hash_t hash_value, const index_t index)
+	{
+		if (m_metadata[slot].is_slot_deleted())
+			--m_deleted_count;
+		m_metadata[slot] = metadata_t{ metadata_t::get_h2_hash(hash_value) };
+		m_indices[slot] = index;
+	}
+	// erase the pair a slot refers to, the last pair is moved into its place
+	inline void erase_slot(const size_t slot);
+	// build a new index table for the pairs, only indices and control bytes are written
+	inline void rebuild(const size_t new_capacity);
+	// allocate an index table with every slot empty
+	inline void allocate_table(const size_t capacity);
+	// free the index table
+	inline void deallocate_table();
+	// number of cache lines in the index table block, control bytes then indices
+	static constexpr size_t get_table_line_count(const size_t capacity)
+	{
+		return (capacity * (sizeof(metadata_t) + sizeof(index_t)) + details::s_cache_line_size - 1) / details::s_cache_line_size;
+	}
+private:
+	// returned by slot lookups for a missing key
+	static constexpr const size_t s_npos = ~size_t{ 0 };
+	// smallest index table, a single group so probing never runs past the end
+	static constexpr const size_t s_min_capacity = group_t::s_width;
+	// indices are stored in 4 bytes
+	static constexpr const size_t s_max_pair_count = 0xFFFF'FFFFull;
+
+	// packed pairs, m_indices refers to them by position
+	std::vector<hash_map_pair_t, pair_allocator_t> m_pairs{};
+	// control bytes of the index table, nullptr until the first insertion
+	metadata_t* m_metadata = nullptr;
+	// pair index of every occupied slot, directly after the control bytes in the same block
+	index_t* m_indices = nullptr;
+	// number of slots in the index table, a power of two
+	size_t m_capacity = 0;
+	// number of deleted slots in the index table
+	size_t m_deleted_count = 0;
+	// hasher
+	hasher_t m_hasher{};
+	// key equality function
+	key_equal_t m_key_equal{};
+	// allocator for the index table
+	block_allocator_t m_allocator{};
+};
+
+// ============================
+// start implementation details
+// ============================
+
+// copy constructor
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::dense_flat_hash_map(const dense_flat_hash_map& other)
+	: m_pairs{ other.m_pairs }, m_deleted_count{ other.m_deleted_count }, m_hasher{ other.m_hasher }, m_key_equal{ other.m_key_equal },
+	m_allocator{ block_allocator_traits_t::select_on_container_copy_construction(other.m_allocator) }
+{
+	if (!other.m_capacity)
+		return;
+
+	allocate_table(other.m_capacity);
+	std::memcpy(m_metadata, other.m_metadata, sizeof(metadata_t) * m_capacity);
+	std::memcpy(m_indices, other.m_indices, sizeof(index_t) * m_capacity);
+}
+
+// move constructor
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::dense_flat_hash_map(dense_flat_hash_map&& other) noexcept
+	: m_pairs{ std::move(other.m_pairs) }, m_metadata{ std::exchange(other.m_metadata, nullptr) }, m_indices{ std::exchange(other.m_indices, nullptr) },
+	m_capacity{ std::exchange(other.m_capacity, 0) }, m_deleted_count{ std::exchange(other.m_deleted_count, 0) },
+	m_hasher{ std::move(other.m_hasher) }, m_key_equal{ std::move(other.m_key_equal) }, m_allocator{ std::move(other.m_allocator) }
+{
+	other.m_pairs.clear();
+}
+
+// copy assign operator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>& dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::operator=(const dense_flat_hash_map& other)
+{
+	if (this != &other)
+	{
+		dense_flat_hash_map copy{ other };
+		swap(copy);
+	}
+
+	return *this;
+}
+
+// move assign operator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>& dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::operator=(dense_flat_hash_map&& other) noexcept
+{
+	if (this != &other)
+	{
+		clear();
+		swap(other);
+	}
+
+	return *this;
+}
+
+// destroy every pair and free the index table
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::clear()
+{
+	m_pairs.clear();
+	m_pairs.shrink_to_fit();
+	deallocate_table();
+	m_deleted_count = 0;
+}
+
+// insert or replace a pair
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::emplace(key_t&& key, value_t&& value)
+{
+	const hash_t hash_value = hash_key(key);
+	bool found;
+	const size_t slot = find_or_prepare_insert(key, hash_value, found);
+	if (found)
+	{
+		m_pairs[m_indices[slot]].value = std::move(value);
+		return;
+	}
+
+	// the pair is appended before the slot is written, so a throwing constructor or allocation leaves the table untouched
+	m_pairs.emplace_back(std::move(key), std::move(value));
+	set_slot(slot, hash_value, static_cast<index_t>(m_pairs.size() - 1));
+}
+
+// construct the value of a missing key in-place at the end of the pair array
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename key_arg_t, typename... Args>
+details::hash_map_pair<K, V>& dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::try_emplace(key_arg_t&& key, Args&&... args)
+{
+	const hash_t hash_value = hash_key(key);
+	bool found;
+	const size_t slot = find_or_prepare_insert(key, hash_value, found);
+	if (found)
+		return m_pairs[m_indices[slot]];
+
+	// the pair is appended before the slot is written, so a throwing constructor or allocation leaves the table untouched
+	hash_map_pair_t& pair = m_pairs.emplace_back(std::piecewise_construct, std::forward<key_arg_t>(key), std::forward<Args>(args)...);
+	set_slot(slot, hash_value, static_cast<index_t>(m_pairs.size() - 1));
+	return pair;
+}
+
+// erase a pair
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::erase(const key_t& key)
+{
+	const size_t slot = find_slot_of(key, hash_key(key));
+	if (slot == s_npos)
+	{
+#ifdef KB_DEBUG
+		KB_CORE_ASSERT(false, "key does not exist in map!");
+#endif
+		return;
+	}
+
+	erase_slot(slot);
+}
+
+// erase the pair an iterator points to
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+typename dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::iterator dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::erase(citerator it)
+{
+	const index_t index = static_cast<index_t>(it - begin());
+
+	KB_CORE_ASSERT(index < m_pairs.size(), "tried erasing past the end of the map!");
+
+	erase_slot(find_slot_of_index(hash_key(it->key), index));
+	return begin() + index;
+}
+
+// swap the contents
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::swap(dense_flat_hash_map& other)
+{
+	m_pairs.swap(other.m_pairs);
+	std::swap(m_metadata, other.m_metadata);
+	std::swap(m_indices, other.m_indices);
+	std::swap(m_capacity, other.m_capacity);
+	std::swap(m_deleted_count, other.m_deleted_count);
+	std::swap(m_hasher, other.m_hasher);
+	std::swap(m_key_equal, other.m_key_equal);
+	if constexpr (block_allocator_traits_t::propagate_on_container_swap::value)
+		std::swap(m_allocator, other.m_allocator);
+}
+
+// reserve room for pairs and an index table that holds them without growing
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::reserve(const size_t new_size)
+{
+	KB_CORE_ASSERT(new_size <= s_max_pair_count, "dense map can not hold more than 2^32 - 1 pairs!");
+
+	m_pairs.reserve(new_size);
+
+	size_t new_capacity = std::max(m_capacity, s_min_capacity);
+	while (new_capacity - new_capacity / 8 <= new_size)
+		new_capacity *= 2;
+
+	if (new_capacity != m_capacity)
+		rebuild(new_capacity);
+}
+
+// access a specific element with bounds checking
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+V& dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::at(const K& key)
+{
+	const size_t slot = find_slot_of(key, hash_key(key));
+
+	KB_CORE_ASSERT(slot != s_npos, "key does not exist in the map!");
+
+	return m_pairs[m_indices[slot]].value;
+}
+
+// access a specific element with bounds checking
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+const V& dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::at(const K& key) const
+{
+	const size_t slot = find_slot_of(key, hash_key(key));
+
+	KB_CORE_ASSERT(slot != s_npos, "key does not exist in the map!");
+
+	return m_pairs[m_indices[slot]].value;
+}
+
+// probe groups of control bytes, only slots whose h2 matches read their pair to compare keys
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline size_t dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::find_slot_of(const key_t& key, const hash_t hash_value) const
+{
+	if (!m_capacity)
+		return s_npos;
+
+	const h2_t h2_hash = metadata_t::get_h2_hash(hash_value);
+	probe_sequence_t probe{ metadata_t::get_h1_hash(hash_value), m_capacity - 1 };
+
+	while (true)
+	{
+		const group_t group{ m_metadata + probe.get_offset() };
+		for (const size_t i : group.match(h2_hash))
+		{
+			const size_t slot = probe.get_offset(i);
+			if (m_key_equal(m_pairs[m_indices[slot]].key, key))
+				return slot;
+		}
+
+		if (group.match_empty())
+			return s_npos;
+
+		probe.next();
+	}
+}
+
+// same probe sequence as find_slot_of, but compares indices instead of keys
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline size_t dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::find_slot_of_index(const hash_t hash_value, const index_t index) const
+{
+	const h2_t h2_hash = metadata_t::get_h2_hash(hash_value);
+	probe_sequence_t probe{ metadata_t::get_h1_hash(hash_value), m_capacity - 1 };
+
+	while (true)
+	{
+		const group_t group{ m_metadata + probe.get_offset() };
+		for (const size_t i : group.match(h2_hash))
+		{
+			const size_t slot = probe.get_offset(i);
+			if (m_indices[slot] == index)
+				return slot;
+		}
+
+		KB_CORE_ASSERT(!group.match_empty(), "pair index does not exist in the index table!");
+
+		probe.next();
+	}
+}
+
+// first free slot in the probe sequence, the table always has one since it is never completely full
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline size_t dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::find_insert_slot_of(const hash_t hash_value) const
+{
+	probe_sequence_t probe{ metadata_t::get_h1_hash(hash_value), m_capacity - 1 };
+
+	while (true)
+	{
+		const group_t group{ m_metadata + probe.get_offset() };
+		if (const mask_t free_slots = group.match_empty_or_deleted())
+			return probe.get_offset(free_slots.lowest_index());
+
+		probe.next();
+	}
+}
+
+// find a key, or a free slot for it
+// reusing a deleted slot never changes the load, so only taking an empty slot can trigger a rebuild
+// mostly deleted tables are rebuilt at the same size, same heuristic as flat_unordered_hash_map
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline size_t dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::find_or_prepare_insert(const key_t& key, const hash_t hash_value, bool& found)
+{
+	const size_t existing_slot = find_slot_of(key, hash_value);
+	found = existing_slot != s_npos;
+	if (found)
+		return existing_slot;
+
+	KB_CORE_ASSERT(m_pairs.size() < s_max_pair_count, "dense map can not hold more than 2^32 - 1 pairs!");
+
+	if (!m_capacity)
+	{
+		allocate_table(s_min_capacity);
+		return find_insert_slot_of(hash_value);
+	}
+
+	size_t slot = find_insert_slot_of(hash_value);
+	if (m_metadata[slot].is_slot_deleted())
+		return slot;
+
+	if (m_pairs.size() + m_deleted_count + 1 >= get_max_load())
+	{
+		const bool drop_deleted = m_deleted_count > 0 && m_pairs.size() * 28 <= get_max_load() * 25;
+		rebuild(drop_deleted ? m_capacity : m_capacity * 2);
+		slot = find_insert_slot_of(hash_value);
+	}
+
+	return slot;
+}
+
+// erase the pair of a slot
+// the slot is freed like in flat_unordered_hash_map, then the last pair is moved into the hole and its slot repointed
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::erase_slot(const size_t slot)
+{
+	const index_t index = m_indices[slot];
+
+	const group_t group{ m_metadata + (slot & ~(group_t::s_width - 1)) };
+	if (group.match_empty())
+		m_metadata[slot] = metadata_t{ metadata_t::empty_bit_flag };
+	else
+	{
+		m_metadata[slot] = metadata_t{ metadata_t::deleted_bit_flag };
+		++m_deleted_count;
+	}
+
+	const index_t last_index = static_cast<index_t>(m_pairs.size() - 1);
+	if (index != last_index)
+	{
+		hash_map_pair_t& last = m_pairs[last_index];
+		m_indices[find_slot_of_index(hash_key(last.key), last_index)] = index;
+		m_pairs[index] = std::move(last);
+	}
+
+	m_pairs.pop_back();
+}
+
+// rebuild the index table, pairs stay where they are
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::rebuild(const size_t new_capacity)
+{
+#ifdef KB_DEBUG
+	KB_CORE_INFO("[dense_flat_hash_map]: rebuilding index table, {} -> {} slots", m_capacity, new_capacity);
+#endif
+
+	deallocate_table();
+	allocate_table(new_capacity);
+	m_deleted_count = 0;
+
+	for (size_t i = 0; i < m_pairs.size(); ++i)
+	{
+		const hash_t hash_value = hash_key(m_pairs[i].key);
+		set_slot(find_insert_slot_of(hash_value), hash_value, static_cast<index_t>(i));
+	}
+}
+
+// allocate the control bytes and indices as one cache line aligned block
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::allocate_table(const size_t capacity)
+{
+	details::cache_line* block = block_allocator_traits_t::allocate(m_allocator, get_table_line_count(capacity));
+	m_metadata = reinterpret_cast<metadata_t*>(block);
+	m_indices = reinterpret_cast<index_t*>(reinterpret_cast<uint8_t*>(block) + sizeof(metadata_t) * capacity);
+	m_capacity = capacity;
+
+	std::uninitialized_fill_n(m_metadata, capacity, metadata_t{});
+}
+
+// free the index table
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline void dense_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::deallocate_table()
+{
+	if (m_metadata)
+		block_allocator_traits_t::deallocate(m_allocator, reinterpret_cast<details::cache_line*>(m_metadata), get_table_line_count(m_capacity));
+
+	m_metadata = nullptr;
+	m_indices = nullptr;
+	m_capacity = 0;
+}
+
+// ==========================
+// end implementation details
+// ==========================
+
+} // end namespace Kablunk::util::container
+
+#endif
@@ -1,6 +1,41 @@
 #include "flat_unordered_hash_map.hpp"
 
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace Kablunk::util::container;
+
+    // fill a map right up to its load factor and print how many groups lookups had to probe
+    // hits probe for keys in the map, misses probe for keys that were never inserted
+    template <typename K, typename make_key_t>
+    void print_probe_length_distribution(const char* name, make_key_t make_key)
+    {
+        static constexpr size_t max_elements = 1ull << 16;
+        static constexpr size_t element_count = static_cast<size_t>(max_elements * 0.875f) - 2;
+        static constexpr size_t max_probe_length = 8;
+
+        flat_unordered_hash_map<K, int> map;
+        map.reserve(max_elements);
+        for (size_t i = 0; i < element_count; ++i)
+            map.insert(make_key(i), static_cast<int>(i));
+
+        std::vector<size_t> hits(max_probe_length + 1), misses(max_probe_length + 1);
+        for (size_t i = 0; i < element_count; ++i)
+        {
+            ++hits[std::min(map.get_probe_length(make_key(i)), max_probe_length)];
+            ++misses[std::min(map.get_probe_length(make_key(i + element_count)), max_probe_length)];
+        }
+
+        std::cout << name << " (" << map.size() << " / " << map.max_size() << " slots)" << std::endl;
+        for (size_t length = 1; length <= max_probe_length; ++length)
+            std::cout << "  " << length << (length == max_probe_length ? "+" : " ") << " groups: "
+                << hits[length] << " hits, " << misses[length] << " misses" << std::endl;
+    }
+}
 
 int main(int argc, char** argv)
 {
@@ -15,5 +50,10 @@ int main(int argc, char** argv)
         std::cout << key << " " << value << " ";
     std::cout << std::endl;
 
+    // probe lengths for key sets that commonly cause clustering
+    print_probe_length_distribution<uint64_t>("sequential integers", [](size_t i) { return static_cast<uint64_t>(i); });
+    print_probe_length_distribution<uint64_t>("strided integers", [](size_t i) { return static_cast<uint64_t>(i) << 12; });
+    print_probe_length_distribution<std::string>("common prefix strings", [](size_t i) { return "session:user:" + std::to_string(i); });
+
     return 0;
-}
\ No newline at end of file
+}
@@ -3,9 +3,29 @@
 #define KABLUNK_UTILITIES_CONTAINER_FLAT_HASH_MAP_HPP
 
 #include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 #include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER)
+#	include <intrin.h> // _umul128, _mm_prefetch
+#endif
+
+// std::span overloads of the batched lookups are only available from c++20
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#	include <span>
+#endif
 
 // include for Kablunk Engine core code
 #ifdef KB_PLATFORM_WINDOWS
@@ -13,13 +33,49 @@
 #else
 #   if defined(_MSC_VER)
 #       define KB_CORE_ASSERT(x, ...) { if (!(x)) __debugbreak(); }
-#		include <emmintrin.h> // see2 instructions
 #   else
 #       define KB_CORE_ASSERT(x, ...) { }
-#       warning "msvc is the only supported compiler!"
 #   endif
 #endif
 
+// simd backends used to probe a group of metadata at once
+#define KB_FLAT_HASH_MAP_SIMD_PORTABLE 0
+#define KB_FLAT_HASH_MAP_SIMD_SSE2 1
+#define KB_FLAT_HASH_MAP_SIMD_AVX2 2
+
+// the backend is picked at compile time from the target instruction set
+// define KB_FLAT_HASH_MAP_SIMD to one of the values above before including this header to force a backend
+// the group width is part of the table layout, so the backend cannot change at runtime
+#ifndef KB_FLAT_HASH_MAP_SIMD
+#   if defined(__AVX2__)
+#       define KB_FLAT_HASH_MAP_SIMD KB_FLAT_HASH_MAP_SIMD_AVX2
+#   elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define KB_FLAT_HASH_MAP_SIMD KB_FLAT_HASH_MAP_SIMD_SSE2
+#   else
+#       define KB_FLAT_HASH_MAP_SIMD KB_FLAT_HASH_MAP_SIMD_PORTABLE
+#   endif
+#endif
+
+#if KB_FLAT_HASH_MAP_SIMD == KB_FLAT_HASH_MAP_SIMD_AVX2
+#   include <immintrin.h> // avx2 instructions
+#elif KB_FLAT_HASH_MAP_SIMD == KB_FLAT_HASH_MAP_SIMD_SSE2
+#   include <emmintrin.h> // sse2 instructions
+#endif
+
+// define KB_FLAT_HASH_MAP_STATS to 1 before including this header to count probing and rebuild statistics per map
+// they are read with stats(), when compiled out (the default) the counters take no space and no time
+#ifndef KB_FLAT_HASH_MAP_STATS
+#   define KB_FLAT_HASH_MAP_STATS 0
+#endif
+
+#if KB_FLAT_HASH_MAP_STATS
+#   include <atomic>
+#   include <chrono>
+#   define KB_FLAT_HASH_MAP_STATS_ONLY(...) __VA_ARGS__
+#else
+#   define KB_FLAT_HASH_MAP_STATS_ONLY(...)
+#endif
+
 /*
  * documentation for sse2 instructions http://const.me/articles/simd/simd.pdf 
  */
@@ -30,62 +86,157 @@ namespace Kablunk::util::container
 namespace hash
 { // start namespace ::hash
 
-	// algorithm from https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
-	template <typename T> 
-	inline uint64_t generate_u64_fnv1a_hash(const T& value)
+	// seeds and multiplication constants used by the default hasher
+	// values are from wyhash https://github.com/wangyi-fudan/wyhash
+	static constexpr const uint64_t s_default_seed = 0xa0761d6478bd642full;
+	static constexpr const uint64_t s_secret[4] = {
+		0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull, 0x1d8e4e27c47d124full
+	};
+
+	// multiply two 64 bit values into a 128 bit result and fold the high and low halves together with xor
+	// a single multiply like this mixes the input bits into both the low (h1) and high (h2) bits of the hash
+	inline uint64_t fold_multiply(uint64_t lhs, uint64_t rhs)
 	{
-		static_assert(false, "value_t does not support hashing!");
+#if defined(__SIZEOF_INT128__)
+		const __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+		return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		uint64_t high;
+		const uint64_t low = _umul128(lhs, rhs, &high);
+		return low ^ high;
+#else
+		// portable 64x64 -> 128 multiply using 32 bit halves
+		const uint64_t lhs_lo = lhs & 0xFFFFFFFF, lhs_hi = lhs >> 32;
+		const uint64_t rhs_lo = rhs & 0xFFFFFFFF, rhs_hi = rhs >> 32;
+		const uint64_t lo_lo = lhs_lo * rhs_lo, hi_lo = lhs_hi * rhs_lo;
+		const uint64_t lo_hi = lhs_lo * rhs_hi, hi_hi = lhs_hi * rhs_hi;
+		const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+		const uint64_t high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+		const uint64_t low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+		return low ^ high;
+#endif
 	}
 
-	// template specialization for uint64_t
-	template <>
-	inline uint64_t generate_u64_fnv1a_hash(const uint64_t& value)
+	// unaligned little endian loads used when hashing byte buffers
+	inline uint64_t read_u64(const uint8_t* data) { uint64_t value; std::memcpy(&value, data, sizeof(value)); return value; }
+	inline uint64_t read_u32(const uint8_t* data) { uint32_t value; std::memcpy(&value, data, sizeof(value)); return value; }
+	// reads 1 to 3 bytes, spreading them across a 64 bit value
+	inline uint64_t read_small(const uint8_t* data, size_t length)
+	{
+		return (static_cast<uint64_t>(data[0]) << 16) | (static_cast<uint64_t>(data[length >> 1]) << 8) | data[length - 1];
+	}
+
+	// cheap multiply-xorshift mixer for integer keys
+	// a single folded multiply is enough to spread the entropy of small or sequential integers into all 64 bits
+	inline uint64_t mix_u64(uint64_t value)
+	{
+		return fold_multiply(value ^ s_secret[0], s_default_seed);
+	}
+
+	// word-at-a-time hash for arbitrary byte buffers based on wyhash https://github.com/wangyi-fudan/wyhash
+	// consumes 32 bytes per step in two independent lanes, then finishes the remaining tail 16, 8, or 4 bytes at a time
+	inline uint64_t hash_bytes(const void* buffer, size_t length, uint64_t seed = s_default_seed)
 	{
-		static constexpr const uint64_t FNV_offset_basis = 0xcbf29ce484222325;
-		// FNV prime is large prime
-		static constexpr const uint64_t FNV_prime = 0x100000001b3;
-		uint64_t hashed_value = FNV_offset_basis;
+		const uint8_t* data = static_cast<const uint8_t*>(buffer);
+		seed ^= fold_multiply(seed ^ s_secret[0], s_secret[1]);
 
-		// iterate through each byte of data to hash
-		for (size_t i = 0; i < sizeof(value); ++i)
+		uint64_t a, b;
+		if (length <= 16)
+		{
+			if (length >= 4)
+			{
+				// two possibly overlapping reads cover 4 to 16 bytes without branching on every byte
+				const size_t offset = (length >> 3) << 2;
+				a = (read_u32(data) << 32) | read_u32(data + offset);
+				b = (read_u32(data + length - 4) << 32) | read_u32(data + length - 4 - offset);
+			}
+			else if (length > 0)
+			{
+				a = read_small(data, length);
+				b = 0;
+			}
+			else
+				a = b = 0;
+		}
+		else
 		{
-			// xor the lower 8 bits of the hash with the current byte of data
-			hashed_value = (hashed_value & 0xFFFFFFFFFFFFFF00) | ((hashed_value >> 8) & 0xFF) ^ ((value >> (i * 8)) & 0xFF);
-			// multiply hashed value with prime constant
-			hashed_value = hashed_value * FNV_prime;
+			size_t remaining = length;
+			if (remaining > 32)
+			{
+				uint64_t second_seed = seed;
+				do
+				{
+					seed = fold_multiply(read_u64(data) ^ s_secret[1], read_u64(data + 8) ^ seed);
+					second_seed = fold_multiply(read_u64(data + 16) ^ s_secret[2], read_u64(data + 24) ^ second_seed);
+					data += 32;
+					remaining -= 32;
+				} while (remaining > 32);
+				seed ^= second_seed;
+			}
+
+			while (remaining > 16)
+			{
+				seed = fold_multiply(read_u64(data) ^ s_secret[1], read_u64(data + 8) ^ seed);
+				data += 16;
+				remaining -= 16;
+			}
+
+			// the last 16 bytes are always read in full, overlapping already consumed bytes if necessary
+			a = read_u64(data + remaining - 16);
+			b = read_u64(data + remaining - 8);
 		}
 
-		return hashed_value;
+		a ^= s_secret[1];
+		b ^= seed;
+		// finalize with the length so buffers that only differ by trailing zeros hash differently
+		return fold_multiply(fold_multiply(a, b) ^ s_secret[0] ^ length, b ^ s_secret[1]);
 	}
 
-	// #TODO research how to specialize void* template so arbitrary types can work
-	// template specialization for void*
-	/*template <>
-	inline uint64_t generate_u64_fnv1a_hash(const void*& value)
+	// default hasher used by flat_unordered_hash_map
+	// falls back to std::hash for types without a specialization, post mixed so low quality (identity) hashes
+	// still have entropy in the h2 bits
+	template <typename T, typename = void>
+	struct hasher
 	{
-		// cast to uint64_t and use that specialization
-		return generate_u64_fnv1a_hash<uint64_t>(static_cast<uint64_t>(value));
-	}*/
+		inline uint64_t operator()(const T& value) const { return mix_u64(static_cast<uint64_t>(std::hash<T>{}(value))); }
+	};
 
-	template <>
-	inline uint64_t generate_u64_fnv1a_hash<std::string>(const std::string& value)
+	// specialization for integers, enums and pointers
+	template <typename T>
+	struct hasher<T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>>>
 	{
-		static constexpr const uint64_t FNV_offset_basis = 14695981039346656037ull;
-		// FNV prime is large prime
-		static constexpr const uint64_t FNV_prime = 1099511628211ull;
-		uint64_t hashed_value = FNV_offset_basis;
-
-		// iterate through each byte of data to hash
-		for (size_t i = 0; i < value.size(); ++i)
+		inline uint64_t operator()(const T& value) const
 		{
-			// xor the lower 8 bits of the hash with the current byte of data
-			hashed_value = (hashed_value & 0xFFFFFFFFFFFFFF00) | (hashed_value & 0xFF) ^ static_cast<uint8_t>(value[i]);
-			// multiply hashed value with prime constant
-			hashed_value = hashed_value * FNV_prime;
+			if constexpr (std::is_pointer_v<T>)
+				return mix_u64(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+			else
+				return mix_u64(static_cast<uint64_t>(value));
 		}
+	};
 
-		return hashed_value;
-	}
+	// hashes the characters of a string, so std::string, std::string_view and const char* with the same contents
+	// always hash the same, which heterogeneous lookups rely on
+	struct string_hasher
+	{
+		using is_transparent = void;
+
+		inline uint64_t operator()(std::string_view value) const { return hash_bytes(value.data(), value.size()); }
+	};
+
+	// specialization for std::string
+	template <>
+	struct hasher<std::string> : string_hasher { };
+
+	// specialization for std::string_view
+	template <>
+	struct hasher<std::string_view> : string_hasher { };
+
+	// default key equality used by flat_unordered_hash_map
+	// transparent for string keys, so together with string_hasher they can be looked up without constructing a temporary key
+	template <typename T>
+	using key_equal = std::conditional_t<
+		std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>, std::equal_to<>, std::equal_to<T>
+	>;
 
 } // end namespace ::hash
 
@@ -98,17 +249,26 @@ namespace details
 	{
 		static constexpr const uint8_t empty_bit_flag{ 0b10000000 };
 		static constexpr const uint8_t occupied_bit_flag{ 0b00000000 };
-		static constexpr const uint8_t deleted_bit_flag{ 0b10000000 };
+		static constexpr const uint8_t deleted_bit_flag{ 0b11111110 };
+		// marks the end of the metadata array, never matched by any probe
+		static constexpr const uint8_t sentinel_bit_flag{ 0b11111111 };
 		// h1 mask is the lowest 57 bits of a hash
 		static constexpr const size_t h1_hash_mask = 0x01FFFFFFFFFFFFFF;
 		// h2 mask is the highest 7 bits of a hash
 		static constexpr const size_t h2_hash_mask = 0xFE00000000000000;
 		// bits that can be used as metadata flags to optimize lookup and insertion
-		// lowest bit stores a flag for whether an entry is empty (1), full (0), or deleted (1)
-		// highest 7 bits store an "h2" hash (highest 7 bits of a hash)
+		// highest bit stores a flag for whether an entry is empty or deleted (1), or full (0)
+		// when full, the lowest 7 bits store an "h2" hash (highest 7 bits of a hash)
+		// empty (0x80), deleted (0xFE) and the sentinel (0xFF) are distinguishable with simple signed compares
 		uint8_t m_data{ empty_bit_flag };
 
+		// get the h1 hash (lowest 57 bits) from a full hash, used to find the start of a probe sequence
+		static inline size_t get_h1_hash(const uint64_t hash) { return static_cast<size_t>(hash & h1_hash_mask); }
+		// get the h2 hash (highest 7 bits) from a full hash, stored in the metadata slot
+		static inline uint8_t get_h2_hash(const uint64_t hash) { return static_cast<uint8_t>((hash & h2_hash_mask) >> 0x39); }
+
 		swiss_table_metadata() = default;
+		explicit constexpr swiss_table_metadata(const uint8_t data) : m_data{ data } { }
 		swiss_table_metadata(const swiss_table_metadata&) = default;
 		swiss_table_metadata(swiss_table_metadata&&) = default;
 		~swiss_table_metadata() = default;
@@ -119,11 +279,333 @@ namespace details
 		// helper function to check whether the metadata slot is occupied
 		inline bool is_slot_occupied() const { return (m_data & empty_bit_flag) == occupied_bit_flag; }
 		// helper function to check whether the metadata slot is empty
-		inline bool is_slot_empty() const { return (m_data & 0xFF) == empty_bit_flag; }
+		inline bool is_slot_empty() const { return m_data == empty_bit_flag; }
 		// helper function to check whether the metadata slot is deleted
-		inline bool is_slot_deleted() const { return (m_data & deleted_bit_flag) == deleted_bit_flag; }
+		inline bool is_slot_deleted() const { return m_data == deleted_bit_flag; }
+	};
+
+	// portable count trailing zeros, value must not be 0
+	inline uint32_t count_trailing_zeros(uint64_t value)
+	{
+		KB_CORE_ASSERT(value != 0, "count trailing zeros of 0 is undefined");
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return static_cast<uint32_t>(index);
+#else
+		return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+	}
+
+	// hint the cpu to start loading a cache line, does nothing on unknown compilers
+	inline void prefetch(const void* address)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(address);
+#else
+		(void)address;
+#endif
+	}
+
+	// hint the cpu that we are busy waiting, lowers power usage and frees resources for a sibling hyper-thread
+	inline void cpu_relax()
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__)
+		asm volatile("yield");
+#endif
+	}
+
+	// run task(thread_index) for every thread index below thread_count, the calling thread runs index 0
+	// returns once every task is done
+	template <typename task_t>
+	inline void parallel_for(const size_t thread_count, task_t&& task)
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count - 1);
+		for (size_t thread_index = 1; thread_index < thread_count; ++thread_index)
+			threads.emplace_back([&task, thread_index]() { task(thread_index); });
+
+		task(0);
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	// bit mask returned by group matching, each bit (or byte for the portable backend) corresponds to one slot
+	// can be iterated with a range based for loop to visit the index of each matching slot in order
+	// shift is log2 of the number of bits used per slot
+	template <typename T, uint32_t Shift>
+	class group_bit_mask
+	{
+	public:
+		explicit group_bit_mask(T mask) : m_mask{ mask } { }
+
+		// check whether any slot matched
+		explicit operator bool() const { return m_mask != 0; }
+		// index of the first matching slot, mask must not be empty
+		inline size_t lowest_index() const { return count_trailing_zeros(static_cast<uint64_t>(m_mask)) >> Shift; }
+		// raw mask value
+		inline T get_raw_mask() const { return m_mask; }
+		// copy of the mask with every slot before slot_index cleared, slot_index must be smaller than the group width
+		inline group_bit_mask without_slots_before(const size_t slot_index) const
+		{
+			return group_bit_mask{ static_cast<T>(m_mask & static_cast<T>(static_cast<T>(~T{ 0 }) << (slot_index << Shift))) };
+		}
+
+		// iteration helpers so the mask can be used with a range based for loop
+		inline group_bit_mask begin() const { return *this; }
+		inline group_bit_mask end() const { return group_bit_mask{ 0 }; }
+		inline size_t operator*() const { return lowest_index(); }
+		// clear the lowest matching slot
+		inline group_bit_mask& operator++() { m_mask &= (m_mask - 1); return *this; }
+		inline bool operator!=(const group_bit_mask& other) const { return m_mask != other.m_mask; }
+	private:
+		T m_mask;
+	};
+
+#if KB_FLAT_HASH_MAP_SIMD == KB_FLAT_HASH_MAP_SIMD_AVX2
+	// 32 metadata slots probed at once with avx2 instructions
+	struct metadata_group_avx2
+	{
+		using mask_t = group_bit_mask<uint32_t, 0>;
+		static constexpr const size_t s_width = 32ull;
+
+		// load 32 metadata bytes into a register, the pointer does not need to be aligned
+		explicit metadata_group_avx2(const swiss_table_metadata* metadata_buffer)
+			: m_metadata{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(metadata_buffer)) }
+		{ }
+
+		// broadcast h2 to every byte, compare all 32 bytes at once, and pack the high bit of each result byte into a mask
+		inline mask_t match(const uint8_t h2_hash) const
+		{
+			const __m256i match = _mm256_set1_epi8(static_cast<char>(h2_hash));
+			return mask_t{ static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(match, m_metadata))) };
+		}
+		// mask of empty slots
+		inline mask_t match_empty() const { return match(swiss_table_metadata::empty_bit_flag); }
+		// mask of empty or deleted slots, these are the only (signed) bytes smaller than the sentinel (-1)
+		inline mask_t match_empty_or_deleted() const
+		{
+			const __m256i sentinel = _mm256_set1_epi8(static_cast<char>(swiss_table_metadata::sentinel_bit_flag));
+			return mask_t{ static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(sentinel, m_metadata))) };
+		}
+		// mask of occupied slots, these are the only slots with the high bit cleared
+		inline mask_t match_full() const { return mask_t{ ~static_cast<uint32_t>(_mm256_movemask_epi8(m_metadata)) }; }
+
+		__m256i m_metadata;
+	};
+
+	using metadata_group = metadata_group_avx2;
+#elif KB_FLAT_HASH_MAP_SIMD == KB_FLAT_HASH_MAP_SIMD_SSE2
+	// 16 metadata slots probed at once with sse2 instructions
+	struct metadata_group_sse2
+	{
+		using mask_t = group_bit_mask<uint16_t, 0>;
+		static constexpr const size_t s_width = 16ull;
+
+		// load 16 metadata bytes into a register
+		// for _mm_load_si128(), the data needs to be 16 byte aligned
+		// _mm_loadu_si128 has potentially worse performance but data does not need to be aligned
+		explicit metadata_group_sse2(const swiss_table_metadata* metadata_buffer)
+			: m_metadata{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(metadata_buffer)) }
+		{ }
+
+		// broadcast h2 to every byte, compare all 16 bytes at once, and pack the high bit of each result byte into a mask
+		inline mask_t match(const uint8_t h2_hash) const
+		{
+			const __m128i match = _mm_set1_epi8(static_cast<char>(h2_hash));
+			return mask_t{ static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(match, m_metadata))) };
+		}
+		// mask of empty slots
+		inline mask_t match_empty() const { return match(swiss_table_metadata::empty_bit_flag); }
+		// mask of empty or deleted slots, these are the only (signed) bytes smaller than the sentinel (-1)
+		inline mask_t match_empty_or_deleted() const
+		{
+			const __m128i sentinel = _mm_set1_epi8(static_cast<char>(swiss_table_metadata::sentinel_bit_flag));
+			return mask_t{ static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(sentinel, m_metadata))) };
+		}
+		// mask of occupied slots, these are the only slots with the high bit cleared
+		inline mask_t match_full() const { return mask_t{ static_cast<uint16_t>(~_mm_movemask_epi8(m_metadata)) }; }
+
+		__m128i m_metadata;
+	};
+
+	using metadata_group = metadata_group_sse2;
+#else
+	// 8 metadata slots probed at once using 64 bit integer arithmetic (simd within a register)
+	// used on platforms without sse2, bit tricks are from absl's GroupPortableImpl
+	struct metadata_group_portable
+	{
+		// every matching slot sets the high bit of its byte, so the slot index is the bit index / 8
+		using mask_t = group_bit_mask<uint64_t, 3>;
+		static constexpr const size_t s_width = 8ull;
+		// lowest and highest bit of every byte
+		static constexpr const uint64_t s_lsbs = 0x0101010101010101ull;
+		static constexpr const uint64_t s_msbs = 0x8080808080808080ull;
+
+		explicit metadata_group_portable(const swiss_table_metadata* metadata_buffer)
+		{
+			std::memcpy(&m_metadata, metadata_buffer, sizeof(m_metadata));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			// slot 0 needs to be the lowest byte so trailing zero counts map to slot indices
+			m_metadata = __builtin_bswap64(m_metadata);
+#endif
+		}
+
+		// xor zeroes out the bytes equal to h2, then the classic "has zero byte" trick flags them
+		// this can report false positives for a slot directly after a real match, which is fine since keys are compared anyway
+		inline mask_t match(const uint8_t h2_hash) const
+		{
+			const uint64_t x = m_metadata ^ (s_lsbs * h2_hash);
+			return mask_t{ (x - s_lsbs) & ~x & s_msbs };
+		}
+		// empty is the only value with the high bit set and bit 1 cleared
+		inline mask_t match_empty() const { return mask_t{ (m_metadata & ~(m_metadata << 6)) & s_msbs }; }
+		// empty and deleted are the only values with the high bit set and the lowest bit cleared
+		inline mask_t match_empty_or_deleted() const { return mask_t{ (m_metadata & ~(m_metadata << 7)) & s_msbs }; }
+		// occupied slots are the only slots with the high bit cleared
+		inline mask_t match_full() const { return mask_t{ ~m_metadata & s_msbs }; }
+
+		uint64_t m_metadata;
+	};
+
+	using metadata_group = metadata_group_portable;
+#endif
+
+	// triangular (quadratic) probe sequence over group aligned offsets
+	// the n-th probe is at h1 + width * (0, 1, 3, 6, 10, ...), which visits every group exactly once when
+	// the number of groups is a power of two, see https://fgiesen.wordpress.com/2015/02/22/triangular-numbers-mod-2n/
+	template <size_t Width>
+	class probe_sequence
+	{
+	public:
+		probe_sequence(const size_t h1_hash, const size_t capacity_mask)
+			: m_capacity_mask{ capacity_mask }, m_offset{ h1_hash & capacity_mask & ~(Width - 1) }
+		{ }
+
+		// index of the first slot of the current group, always a multiple of the group width
+		inline size_t get_offset() const { return m_offset; }
+		// index of a slot in the current group, groups are aligned so this never wraps past the end of the bucket
+		inline size_t get_offset(const size_t slot) const { return m_offset + slot; }
+		// number of groups probed before the current one
+		inline size_t get_probe_length() const { return m_index / Width; }
+		// move to the next group in the sequence
+		inline void next()
+		{
+			m_index += Width;
+			m_offset = (m_offset + m_index) & m_capacity_mask;
+		}
+	private:
+		size_t m_capacity_mask;
+		size_t m_offset;
+		// total distance moved, in slots
+		size_t m_index = 0;
+	};
+
+	// calls a function when it goes out of scope unless dismissed
+	// undoes the partial work of a copy when constructing one of its elements throws
+	template <typename function_t>
+	class scope_rollback
+	{
+	public:
+		explicit scope_rollback(function_t function)
+			: m_function{ std::move(function) }
+		{ }
+		scope_rollback(const scope_rollback&) = delete;
+		~scope_rollback() { if (m_is_active) m_function(); }
+
+		scope_rollback& operator=(const scope_rollback&) = delete;
+
+		// keep the work, the function is not called
+		inline void dismiss() { m_is_active = false; }
+	private:
+		function_t m_function;
+		bool m_is_active = true;
+	};
+
+	// size of a cache line, the metadata and pair buckets are allocated in units of this
+	static constexpr const size_t s_cache_line_size = 64ull;
+
+	// unit of allocation for the combined metadata and pair block
+	// allocators are rebound to this type so every block starts on a cache line
+	struct alignas(s_cache_line_size) cache_line
+	{
+		uint8_t m_data[s_cache_line_size];
+	};
+
+	// header at the start of a snapshot file written by flat_unordered_hash_map::save, takes up exactly one cache line
+	// it is followed by the metadata and pair buckets, laid out exactly like the in-memory block,
+	// and for string keys by the string arena holding their characters
+	struct alignas(s_cache_line_size) snapshot_header
+	{
+		// "KBFLATHM" read as a little endian integer, files written with the other byte order fail this check
+		static constexpr const uint64_t s_magic = 0x4D4854414C46424Bull;
+		// bumped whenever the layout changes
+		static constexpr const uint32_t s_version = 3;
+
+		// keys are stored in the pairs as they are
+		static constexpr const uint32_t s_key_storage_inline = 0;
+		// pairs store a range of the string arena, which follows the pair bucket until the end of the file
+		static constexpr const uint32_t s_key_storage_string_arena = 1;
+
+		uint64_t magic;
+		uint32_t version;
+		// group width of the simd backend that wrote the file, the probe sequence depends on it
+		uint16_t group_width;
+		uint16_t pair_alignment;
+		// sizes of the stored key, value and pair types, a cheap check that the reader uses the same types
+		uint32_t key_size;
+		uint32_t value_size;
+		uint32_t pair_size;
+		// one of the s_key_storage constants
+		uint32_t key_storage;
+		uint64_t max_elements;
+		uint64_t element_count;
+		uint64_t deleted_count;
+		// byte offset of the pair bucket from the start of the metadata bucket
+		uint64_t pair_bucket_offset;
+	};
+
+	// key of a snapshot pair whose map key is a string
+	struct snapshot_string_key
+	{
+		// byte offset of the characters from the start of the string arena
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	// how the keys of a map are stored in a snapshot file
+	// trivially copyable keys are stored as they are, the characters of strings move to the string arena
+	template <typename K>
+	struct snapshot_key
+	{
+		// key type of the pairs in the file
+		using stored_key_t = K;
+		// key type that lookups into a mapped snapshot take
+		using lookup_key_t = K;
+
+		static constexpr const uint32_t s_storage = snapshot_header::s_key_storage_inline;
 	};
 
+	// specialization for std::string
+	template <>
+	struct snapshot_key<std::string>
+	{
+		using stored_key_t = snapshot_string_key;
+		using lookup_key_t = std::string_view;
+
+		static constexpr const uint32_t s_storage = snapshot_header::s_key_storage_string_arena;
+	};
+
+	// specialization for std::string_view, a view would only store a pointer into this process
+	template <>
+	struct snapshot_key<std::string_view> : snapshot_key<std::string> { };
+
 	template <typename K, typename V>
 	struct hash_map_pair
 	{
@@ -143,15 +625,19 @@ namespace details
 		hash_map_pair(key_t&& key, value_t&& value)
 			: key{ std::move(key) }, value{ std::move(value) }
 		{ }
+		// construct the key from key and the value in-place from args
+		// used for pairs that are never moved (e.g. nodes), and for keys of another type inserted by operator[]
+		template <typename key_arg_t, typename... Args>
+		hash_map_pair(std::piecewise_construct_t, key_arg_t&& key, Args&&... args)
+			: key(std::forward<key_arg_t>(key)), value(std::forward<Args>(args)...)
+		{ }
 		hash_map_pair(const hash_map_pair& other)
 			: key{ other.key }, value{ other.value }
 		{ }
+		// the moved from pair is left in a valid but unspecified state, the map destroys it right after
 		hash_map_pair(hash_map_pair&& other) noexcept
 			: key{ std::move(other.key) }, value{ std::move(other.value) }
-		{ 
-			other.key = {};
-			other.value = {};
-		}
+		{ }
 
 		// copy assign operator
 		hash_map_pair& operator=(const hash_map_pair& other)
@@ -175,7 +661,7 @@ namespace details
 		// overload for structured binding
 		// returns reference
 		template <std::size_t _index>
-		std::tuple_element_t<_index, hash_map_pair>& get()
+		std::tuple_element_t<_index, hash_map_pair>& get() &
 		{
 			if constexpr (_index == 0) { return key; }
 			if constexpr (_index == 1) { return value; }
@@ -184,7 +670,7 @@ namespace details
 		// overload for structured binding
 		// returns const reference
 		template <std::size_t _index>
-		const std::tuple_element_t<_index, hash_map_pair>& get() const
+		const std::tuple_element_t<_index, hash_map_pair>& get() const&
 		{
 			if constexpr (_index == 0) { return key; }
 			if constexpr (_index == 1) { return value; }
@@ -193,7 +679,7 @@ namespace details
 		// overload for structured binding
 		// returns rvalue overload
 		template <std::size_t _index>
-		std::tuple_element_t<_index, hash_map_pair>&& get() const
+		std::tuple_element_t<_index, hash_map_pair>&& get() &&
 		{
 			if constexpr (_index == 0) { return std::move(key); }
 			if constexpr (_index == 1) { return std::move(value); }
@@ -204,19 +690,317 @@ namespace details
 		// inequality comparison operator
 		inline bool operator!=(const hash_map_pair& other) const { return !(*this == other); }
 	};
+
+	// key of a slot of the bucket
+	// found through argument dependent lookup, so slots that do not hold their key (e.g. node pointers) can overload it
+	template <typename K, typename V>
+	inline const K& get_slot_key(const hash_map_pair<K, V>& slot) { return slot.key; }
+
+	// whether a hasher or key equality declares is_transparent, i.e. accepts other types than the key type of the map
+	template <typename T, typename = void>
+	struct is_transparent : std::false_type { };
+
+	template <typename T>
+	struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type { };
+
+	// value type of the map underneath flat_unordered_hash_set
+	struct hash_set_value
+	{
+		inline bool operator==(const hash_set_value&) const { return true; }
+		inline bool operator!=(const hash_set_value&) const { return false; }
+	};
+
+	// slot of a flat_unordered_hash_set, only the key is stored
+	// the value is a static member, so code shared with the map can still name it without spending a byte per slot
+	template <typename K>
+	struct hash_map_pair<K, hash_set_value>
+	{
+		using key_t = K;
+		using value_t = hash_set_value;
+
+		// key that is used to hash and store the slot
+		key_t key{};
+		// shared empty value
+		static constexpr const value_t value{};
+
+		hash_map_pair() = default;
+		~hash_map_pair() = default;
+		explicit hash_map_pair(const key_t& key)
+			: key{ key }
+		{ }
+		explicit hash_map_pair(key_t&& key)
+			: key{ std::move(key) }
+		{ }
+		hash_map_pair(const key_t& key, const value_t&)
+			: key{ key }
+		{ }
+		hash_map_pair(key_t&& key, value_t&&)
+			: key{ std::move(key) }
+		{ }
+		hash_map_pair(const hash_map_pair& other) = default;
+		hash_map_pair(hash_map_pair&& other) noexcept = default;
+
+		hash_map_pair& operator=(const hash_map_pair& other) = default;
+		hash_map_pair& operator=(hash_map_pair&& other) noexcept = default;
+
+		// equality comparison operator
+		inline bool operator==(const hash_map_pair& other) const { return key == other.key; }
+		// inequality comparison operator
+		inline bool operator!=(const hash_map_pair& other) const { return !(*this == other); }
+	};
+
+	// metadata of a map without a bucket, a single group of empty slots followed by the sentinel
+	// unallocated maps point at this shared group, so a lookup stops at its first empty slot without checking for a bucket
+	// it is never written, a map allocates its own bucket before the first insertion
+	struct alignas(s_cache_line_size) empty_metadata_group
+	{
+		constexpr empty_metadata_group() { m_data[metadata_group::s_width] = swiss_table_metadata{ swiss_table_metadata::sentinel_bit_flag }; }
+
+		swiss_table_metadata m_data[metadata_group::s_width + 1]{};
+	};
+
+	inline empty_metadata_group s_empty_metadata_group{};
+
+	// layout of the combined block of a map
+	// [metadata + sentinel][padding to a cache line][pairs][stored hashes, if enabled]
+	// groups are only loaded at aligned offsets inside the bucket, so no metadata is needed past the sentinel
+	template <typename Pair, bool StoreHash>
+	struct block_layout
+	{
+		// byte offset of the pair bucket, the pair bucket starts on a cache line after the metadata
+		static constexpr size_t get_pair_bucket_offset(const size_t max_elements)
+		{
+			const size_t metadata_bytes = sizeof(swiss_table_metadata) * (max_elements + 1);
+			return (metadata_bytes + s_cache_line_size - 1) & ~(s_cache_line_size - 1);
+		}
+		// byte offset of the stored hash bucket, directly after the pair bucket
+		static constexpr size_t get_hash_bucket_offset(const size_t max_elements)
+		{
+			const size_t pair_bucket_end = get_pair_bucket_offset(max_elements) + sizeof(Pair) * max_elements;
+			return (pair_bucket_end + alignof(uint64_t) - 1) & ~(alignof(uint64_t) - 1);
+		}
+		// number of cache lines in the block
+		static constexpr size_t get_line_count(const size_t max_elements)
+		{
+			const size_t block_bytes = StoreHash
+				? get_hash_bucket_offset(max_elements) + sizeof(uint64_t) * max_elements
+				: get_pair_bucket_offset(max_elements) + sizeof(Pair) * max_elements;
+			return (block_bytes + s_cache_line_size - 1) / s_cache_line_size;
+		}
+	};
+
+	// bucket size of a map that keeps inline_capacity entries in-object
+	// the smallest power of two, and at least one group, whose max load (7/8 of the slots) fits every entry
+	constexpr size_t get_inline_max_elements(const size_t inline_capacity)
+	{
+		size_t max_elements = metadata_group::s_width;
+		while (max_elements - max_elements / 8 <= inline_capacity)
+			max_elements *= 2;
+
+		return max_elements;
+	}
+
+	// in-object storage for the block of a small map
+	template <size_t LineCount>
+	struct inline_block
+	{
+		inline cache_line* get_inline_lines() { return m_inline_lines; }
+		inline const cache_line* get_inline_lines() const { return m_inline_lines; }
+
+		cache_line m_inline_lines[LineCount];
+	};
+
+	// maps without inline capacity keep no storage, and take up no space as an empty base
+	template <>
+	struct inline_block<0>
+	{
+		inline cache_line* get_inline_lines() { return nullptr; }
+		inline const cache_line* get_inline_lines() const { return nullptr; }
+	};
+
+	template <typename Pair, bool StoreHash, size_t InlineCapacity>
+	using inline_block_t = inline_block<InlineCapacity ? block_layout<Pair, StoreHash>::get_line_count(get_inline_max_elements(InlineCapacity)) : 0>;
+
+	// snapshot of the statistics of a map, returned by stats()
+	// the occupancy is always filled in, the probing and rebuild counters stay zero unless KB_FLAT_HASH_MAP_STATS is enabled
+	struct hash_map_stats
+	{
+		// number of buckets of the probe length histogram, the last bucket also counts every longer probe
+		static constexpr const size_t s_probe_histogram_size = 16ull;
+		// whether the probing and rebuild counters are compiled in
+		static constexpr const bool s_enabled = KB_FLAT_HASH_MAP_STATS != 0;
+
+		// lookups (finds, inserts, and erases) by number of metadata groups probed, bucket i counts lookups that probed i + 1 groups
+		uint64_t probe_length_histogram[s_probe_histogram_size] = {};
+		// metadata groups scanned by lookups, not capped like the histogram
+		uint64_t group_scan_count = 0ull;
+		// candidate slots whose h2 hash matched but whose key did not
+		uint64_t h2_false_positive_count = 0ull;
+		// number of full rebuilds (growing, reserving, merging) and the total time spent in them
+		uint64_t rebuild_count = 0ull;
+		uint64_t rebuild_nanoseconds = 0ull;
+		// number of incremental rebuilds started, their migration is spread over later operations and not timed
+		uint64_t incremental_rebuild_count = 0ull;
+		// occupancy of the bucket
+		size_t element_count = 0ull;
+		size_t deleted_count = 0ull;
+		size_t max_elements = 0ull;
+		// bytes currently allocated by the map
+		size_t allocated_bytes = 0ull;
+
+		// total number of lookups counted by the histogram
+		inline uint64_t get_lookup_count() const
+		{
+			uint64_t lookup_count = 0ull;
+			for (const uint64_t count : probe_length_histogram)
+				lookup_count += count;
+			return lookup_count;
+		}
+		// average number of metadata groups probed per lookup
+		inline double get_mean_probe_length() const
+		{
+			const uint64_t lookup_count = get_lookup_count();
+			return lookup_count ? static_cast<double>(group_scan_count) / static_cast<double>(lookup_count) : 0.0;
+		}
+		// fraction of the bucket taken up by deleted slots (tombstones), which lengthen probing until the next rebuild
+		inline double get_tombstone_ratio() const { return max_elements ? static_cast<double>(deleted_count) / static_cast<double>(max_elements) : 0.0; }
+		// fraction of the bucket that is occupied or deleted
+		inline double get_load() const { return max_elements ? static_cast<double>(element_count + deleted_count) / static_cast<double>(max_elements) : 0.0; }
+	};
+
+#if KB_FLAT_HASH_MAP_STATS
+	// probing and rebuild counters of a single map
+	// const lookups from several threads are allowed, so the counters are relaxed atomics
+	// they are bumped with a plain load and store instead of a locked read-modify-write, concurrent lookups may drop
+	// a few counts but never race, and a single threaded map pays no more than for plain integers
+	class stats_counters
+	{
+	public:
+		stats_counters() = default;
+		// counters describe the traffic of one map object, a copy starts from zero
+		stats_counters(const stats_counters&) { }
+
+		stats_counters& operator=(const stats_counters&) { return *this; }
+
+		// count a lookup that probed probe_length groups and rejected false_positive_count h2 candidates
+		inline void record_lookup(const size_t probe_length, const size_t false_positive_count)
+		{
+			add(m_probe_length_histogram[std::min(probe_length, hash_map_stats::s_probe_histogram_size) - 1], 1ull);
+			add(m_group_scan_count, probe_length);
+			add(m_h2_false_positive_count, false_positive_count);
+		}
+		// count a full rebuild
+		inline void record_rebuild(const uint64_t nanoseconds)
+		{
+			add(m_rebuild_count, 1ull);
+			add(m_rebuild_nanoseconds, nanoseconds);
+		}
+		// count the start of an incremental rebuild
+		inline void record_incremental_rebuild() { add(m_incremental_rebuild_count, 1ull); }
+		// copy the counters into a snapshot
+		inline void fill(hash_map_stats& stats) const
+		{
+			for (size_t i = 0; i < hash_map_stats::s_probe_histogram_size; ++i)
+				stats.probe_length_histogram[i] = m_probe_length_histogram[i].load(std::memory_order_relaxed);
+			stats.group_scan_count = m_group_scan_count.load(std::memory_order_relaxed);
+			stats.h2_false_positive_count = m_h2_false_positive_count.load(std::memory_order_relaxed);
+			stats.rebuild_count = m_rebuild_count.load(std::memory_order_relaxed);
+			stats.rebuild_nanoseconds = m_rebuild_nanoseconds.load(std::memory_order_relaxed);
+			stats.incremental_rebuild_count = m_incremental_rebuild_count.load(std::memory_order_relaxed);
+		}
+		// zero every counter
+		inline void reset()
+		{
+			for (std::atomic<uint64_t>& count : m_probe_length_histogram)
+				count.store(0ull, std::memory_order_relaxed);
+			m_group_scan_count.store(0ull, std::memory_order_relaxed);
+			m_h2_false_positive_count.store(0ull, std::memory_order_relaxed);
+			m_rebuild_count.store(0ull, std::memory_order_relaxed);
+			m_rebuild_nanoseconds.store(0ull, std::memory_order_relaxed);
+			m_incremental_rebuild_count.store(0ull, std::memory_order_relaxed);
+		}
+	private:
+		static inline void add(std::atomic<uint64_t>& counter, const uint64_t amount)
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+	private:
+		std::atomic<uint64_t> m_probe_length_histogram[hash_map_stats::s_probe_histogram_size]{};
+		std::atomic<uint64_t> m_group_scan_count{ 0ull };
+		std::atomic<uint64_t> m_h2_false_positive_count{ 0ull };
+		std::atomic<uint64_t> m_rebuild_count{ 0ull };
+		std::atomic<uint64_t> m_rebuild_nanoseconds{ 0ull };
+		std::atomic<uint64_t> m_incremental_rebuild_count{ 0ull };
+	};
+
+	// times a full rebuild from construction to destruction, so every return path is counted
+	class rebuild_timer
+	{
+	public:
+		explicit rebuild_timer(stats_counters& counters)
+			: m_counters{ counters }, m_start{ std::chrono::steady_clock::now() }
+		{ }
+		rebuild_timer(const rebuild_timer&) = delete;
+		~rebuild_timer()
+		{
+			const auto elapsed = std::chrono::steady_clock::now() - m_start;
+			m_counters.record_rebuild(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+		}
+
+		rebuild_timer& operator=(const rebuild_timer&) = delete;
+	private:
+		stats_counters& m_counters;
+		std::chrono::steady_clock::time_point m_start;
+	};
+#endif
 } // end namespace ::details
 
-template <typename K, typename V>
-class flat_unordered_hash_map
+template <typename K, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+class flat_unordered_hash_set;
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+class node_unordered_hash_map;
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+class split_flat_unordered_hash_map;
+
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+class sharded_flat_hash_map;
+
+template <
+	typename K, 
+	typename V, 
+	typename Hash = hash::hasher<K>, 
+	typename KeyEqual = hash::key_equal<K>, 
+	typename Allocator = std::allocator<details::hash_map_pair<K, V>>,
+	bool StoreHash = false,
+	size_t InlineCapacity = 0
+>
+class flat_unordered_hash_map : private details::inline_block_t<details::hash_map_pair<K, V>, StoreHash, InlineCapacity>
 {
 public:
 	using key_t = K;
 	using value_t = V;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using allocator_t = Allocator;
 	using hash_map_pair_t = details::hash_map_pair<key_t, value_t>;
 	using hash_t = uint64_t;
 	using metadata_t = details::swiss_table_metadata;
-	using mask_t = uint16_t;
+	using group_t = details::metadata_group;
+	using mask_t = typename group_t::mask_t;
+	using probe_sequence_t = details::probe_sequence<group_t::s_width>;
+	// allocator used for the combined metadata and pair block
+	using block_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<details::cache_line>;
+	using block_allocator_traits_t = std::allocator_traits<block_allocator_t>;
+	// layout of the combined block
+	using block_layout_t = details::block_layout<hash_map_pair_t, StoreHash>;
 	using h2_t = uint8_t;
+	// key types accepted by the lookups, any type when both the hasher and the key equality are transparent, otherwise only key_t
+	template <typename key_arg_t>
+	using enable_if_lookup_key_t = std::enable_if_t<
+		std::is_same_v<key_arg_t, key_t> || (details::is_transparent<hasher_t>::value && details::is_transparent<key_equal_t>::value)
+	>;
 public:
 
 	// iterator class for flat_unordered_hash_map
@@ -231,9 +1015,8 @@ public:
 			: m_pair_ptr{ pair_ptr }, m_map_ptr{ map_ptr }
 		{ 
 			// make sure we point to a valid pair
-			const size_t index = m_map_ptr ? pair_ptr - m_map_ptr->m_bucket : 0;
-			if (m_pair_ptr && m_map_ptr && !m_map_ptr->is_slot_occupied(m_map_ptr->m_metadata_bucket[index]))
-				find_next_valid_pair();
+			if (m_pair_ptr && m_map_ptr)
+				find_occupied_pair_from(m_pair_ptr);
 		}
 		// copy constructor
 		iterator(const iterator&) = default;
@@ -247,10 +1030,11 @@ public:
 		{
 			m_pair_ptr = other.m_pair_ptr;
 			m_map_ptr = other.m_map_ptr;
+			return *this;
 		}
 
 		// dereferencing operator
-		hash_map_pair_t& operator*() 
+		hash_map_pair_t& operator*() const
 		{
 			KB_CORE_ASSERT(m_pair_ptr, "invalid pointer");
 
@@ -258,7 +1042,7 @@ public:
 		}
 		
 		// member access operator
-		hash_map_pair_t* operator->() 
+		hash_map_pair_t* operator->() const
 		{
 			KB_CORE_ASSERT(m_pair_ptr, "invalid pointer");
 
@@ -281,9 +1065,14 @@ public:
 			return *this;
 		}
 	private:
+		// move the pointer to the first occupied pair at or after a pair, in iteration order
+		// sets to nullptr if there is no occupied pair left
+		void find_occupied_pair_from(const hash_map_pair_t* pair_ptr)
+		{
+			m_pair_ptr = m_map_ptr->find_occupied_pair_from(pair_ptr);
+		}
 		// increment the pointer so it points to a valid pair
 		// sets to nullptr if it exceeds the end of the map or the original pointer is invalid
-		// #TODO use sse2 instructions to speed up
 		void find_next_valid_pair()
 		{
 			// #TODO this should probably be an assertion
@@ -295,14 +1084,7 @@ public:
 				return;
 			}
 
-			// increment pointer until it finds a valid slot, or is out of bounds
-			const hash_map_pair_t* end = m_map_ptr->m_bucket + m_map_ptr->m_max_elements;
-			while (++m_pair_ptr < end && !m_map_ptr->is_slot_occupied(m_map_ptr->m_metadata_bucket[m_pair_ptr - m_map_ptr->m_bucket]))
-				continue;
-
-			// out of bounds check
-			if (m_pair_ptr >= end)
-				m_pair_ptr = nullptr;
+			find_occupied_pair_from(m_pair_ptr + 1);
 		}
 	private:
 		// pointer to a pair in the hash map
@@ -320,13 +1102,12 @@ public:
 		// default constructor
 		citerator() = default;
 		// constructor that takes a hash map pair
-		citerator(hash_map_pair_t* pair_ptr, const flat_unordered_hash_map* map_ptr)
+		citerator(const hash_map_pair_t* pair_ptr, const flat_unordered_hash_map* map_ptr)
 			: m_pair_ptr{ pair_ptr }, m_map_ptr{ map_ptr }
 		{
 			// make sure we point to a valid pair
-			const size_t index = m_map_ptr ? pair_ptr - m_map_ptr->m_bucket : 0;
-			if (m_pair_ptr && m_map_ptr && !m_map_ptr->is_slot_occupied(m_map_ptr->m_metadata_bucket[index]))
-				find_next_valid_pair();
+			if (m_pair_ptr && m_map_ptr)
+				find_occupied_pair_from(m_pair_ptr);
 		}
 		// copy constructor
 		citerator(const citerator&) = default;
@@ -340,10 +1121,11 @@ public:
 		{
 			m_pair_ptr = other.m_pair_ptr;
 			m_map_ptr = other.m_map_ptr;
+			return *this;
 		}
 
 		// dereferencing operator
-		hash_map_pair_t& operator*()
+		const hash_map_pair_t& operator*() const
 		{
 			KB_CORE_ASSERT(m_pair_ptr, "invalid pointer");
 
@@ -351,7 +1133,7 @@ public:
 		}
 
 		// member access operator
-		hash_map_pair_t* operator->()
+		const hash_map_pair_t* operator->() const
 		{
 			KB_CORE_ASSERT(m_pair_ptr, "invalid pointer");
 
@@ -374,9 +1156,14 @@ public:
 			return *this;
 		}
 	private:
+		// move the pointer to the first occupied pair at or after a pair, in iteration order
+		// sets to nullptr if there is no occupied pair left
+		void find_occupied_pair_from(const hash_map_pair_t* pair_ptr)
+		{
+			m_pair_ptr = m_map_ptr->find_occupied_pair_from(pair_ptr);
+		}
 		// increment the pointer so it points to a valid pair
 		// sets to nullptr if it exceeds the end of the map or the original pointer is invalid
-		// #TODO use sse2 instructions to speed up
 		void find_next_valid_pair()
 		{
 			// #TODO this should probably be an assertion
@@ -388,24 +1175,21 @@ public:
 				return;
 			}
 
-			// increment pointer until it finds a valid slot, or is out of bounds
-			const hash_map_pair_t* end = m_map_ptr->m_bucket + m_map_ptr->m_max_elements;
-			while (++m_pair_ptr < end && !m_map_ptr->is_slot_occupied(m_map_ptr->m_metadata_bucket[m_pair_ptr - m_map_ptr->m_bucket]))
-				continue;
-
-			// out of bounds check
-			if (m_pair_ptr >= end)
-				m_pair_ptr = nullptr;
+			find_occupied_pair_from(m_pair_ptr + 1);
 		}
 	private:
 		// pointer to a pair in the hash map
 		const hash_map_pair_t* m_pair_ptr = nullptr;
 		// pointer to the underlying map, used when finding occupied slots and the end iterator
-		const hash_map_pair_t* m_map_ptr = nullptr;
+		const flat_unordered_hash_map* m_map_ptr = nullptr;
 	};
 public:
 	// default constructor
 	flat_unordered_hash_map();
+	// constructor with a custom allocator
+	explicit flat_unordered_hash_map(const allocator_t& allocator);
+	// constructor with a custom hash, key equality function, and allocator
+	explicit flat_unordered_hash_map(const hasher_t& hasher, const key_equal_t& key_equal = key_equal_t{}, const allocator_t& allocator = allocator_t{});
 	// copy constructor
 	flat_unordered_hash_map(const flat_unordered_hash_map& other);
 	// move constructor
@@ -427,19 +1211,48 @@ public:
 	// returns the number of key-value pairs in the map
 	inline size_t size() const { return m_element_count; };
 	// returns the maximum number of elements that can be in the map before re-allocation of underlying bucket(s)
-	inline size_t max_size() const { return m_max_elements; };
+	inline size_t max_size() const { return m_bucket ? m_max_elements : 0; };
 	// return the default max element count of a map
 	inline constexpr size_t get_default_max_size() { return s_default_max_elements; }
+	// returns the number of bytes allocated for the metadata and pair buckets
+	// includes the old bucket while an incremental rebuild is running, but not the inline block
+	inline size_t get_allocated_bytes() const 
+	{ 
+		const size_t bucket_bytes = m_bucket && !is_inline_block(m_metadata_bucket) 
+			? get_block_line_count(m_max_elements) * details::s_cache_line_size : 0;
+		const size_t rebuild_source_bytes = m_rebuild_source.bucket && !is_inline_block(m_rebuild_source.metadata_bucket) 
+			? get_block_line_count(m_rebuild_source.max_elements) * details::s_cache_line_size : 0;
+		return bucket_bytes + rebuild_source_bytes;
+	}
+	// enable incremental rebuilding, where growing the map moves a bounded number of metadata groups to the new bucket
+	// on every following insert or erase instead of moving every entry at once, 0 disables it (the default)
+	// lookups check both buckets until the migration is finished, and both buckets are allocated at the same time
+	inline void set_incremental_rebuild(const size_t groups_per_operation) { m_incremental_rebuild_group_count = groups_per_operation; }
+	// whether an incremental rebuild is still migrating entries to the new bucket
+	inline bool is_rebuilding() const { return m_rebuild_source.bucket != nullptr; }
+	// rebuild (grow, reserve, resize) with several threads once the map holds at least min_element_count entries
+	// a thread count of 0 uses one thread per hardware thread, 1 rebuilds on the calling thread only (the default)
+	inline void set_parallel_rebuild(const size_t thread_count, const size_t min_element_count = s_default_parallel_rebuild_min_elements)
+	{
+		m_rebuild_thread_count = thread_count;
+		m_parallel_rebuild_min_elements = min_element_count;
+	}
+	// returns a copy of the allocator used by the map
+	inline allocator_t get_allocator() const { return allocator_t{ m_allocator }; }
+	// returns a copy of the hash function used by the map
+	inline hasher_t get_hasher() const { return m_hasher; }
+	// returns a copy of the key equality function used by the map
+	inline key_equal_t get_key_equal() const { return m_key_equal; }
 
 	// =========
 	// modifiers
 	// =========
 
-	// clear all entries and free memory, map is now considered an invalid object unless it is re-initialized
+	// destroy all entries and free memory, map is now considered an invalid object unless it is re-initialized
 	void destroy();
 	// clear all the entries from the map and resize to default map size
 	void clear();
-	// clear all the entries from the map
+	// clear all the entries from the map, keeping the current bucket size
 	void clear_entries();
 	// insert element into the map
 	void insert(const hash_map_pair_t& pair);
@@ -458,7 +1271,10 @@ public:
 	// insert in-place if the key does not exist, otherwise do nothing
 	void try_emplace(hash_map_pair_t&& pair);
 	// erase element(s) from the map
-	void erase(const key_t& key);
+	inline void erase(const key_t& key) { erase<key_t>(key); }
+	// erase an element via a key of another type, see the heterogeneous lookups below
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	void erase(const key_arg_t& key);
 	// swap the contents
 	void swap(flat_unordered_hash_map& other);
 	// extract nodes from the container, removing the pair from the map and copying to a new address
@@ -471,48 +1287,109 @@ public:
 	// is there an optimization to be made where moving a container is faster?
 	// void merge(flag_unordered_hash_map&& other);
 	
+	// replace the contents of the map with a random access range of pairs, hashing and placing them with several threads
+	// the bucket is sized once for the whole range, and when a key appears more than once its first pair is kept
+	// a thread count of 0 uses one thread per hardware thread
+	template <typename iterator_t>
+	void build_parallel(iterator_t first, iterator_t last, size_t thread_count = 0);
+
 	// reserve *more* memory for the map, throws an error if the operation tries to make the map smaller
+	// the size is rounded up to the next power of two
 	void reserve(size_t new_size);
-	// resize the map to a specified size
+	// resize the map to a specified size, rounded up to the next power of two
 	// can make the map smaller, but does not guarantee which keys will be kept
 	void resize(size_t new_size);
+	// write the map to a snapshot file, which mapped_flat_unordered_hash_map::map_file serves read-only without rebuilding it
+	// only for trivially copyable values, and trivially copyable or string keys, returns false if the file could not be written
+	bool save(const char* path) const;
 
 	// ======
 	// lookup
 	// ======
 
+	// the key_arg_t overloads are heterogeneous lookups, available when both the hasher and the key equality declare
+	// is_transparent, like the defaults for std::string keys. a std::string keyed map can then be searched with a
+	// std::string_view or const char* without constructing a temporary key, the hasher must hash equal keys of every
+	// accepted type the same. the key_t overloads take any type convertible to key_t, as before
+
+	// access a specific element with bounds checking
+	inline value_t& at(const key_t& key) { return at<key_t>(key); }
 	// access a specific element with bounds checking
-	value_t& at(const key_t& key);
+	inline const value_t& at(const key_t& key) const { return at<key_t>(key); }
 	// access a specific element with bounds checking
-	const value_t& at(const key_t& key) const;
-	// access or insert a specific element
-	value_t& operator[](const key_t& key);
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	value_t& at(const key_arg_t& key);
+	// access a specific element with bounds checking
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	const value_t& at(const key_arg_t& key) const;
+	// access or insert (default construct) a specific element
+	inline value_t& operator[](const key_t& key) { return operator[]<key_t>(key); }
+	// access or insert (default construct) a specific element, a missing key is constructed from key only when inserted
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	value_t& operator[](const key_arg_t& key);
 	// return the number of elements matching a certain key
 	size_t count(const key_t& key) const;
 	// finds the element with a certain key
-	iterator find(const key_t& key)
+	inline iterator find(const key_t& key) { return find<key_t>(key); }
+	// finds the element with a certain key
+	inline citerator find(const key_t& key) const { return find<key_t>(key); }
+	// finds the element with a certain key
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	iterator find(const key_arg_t& key)
 	{
-		KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
-
-		const size_t index = find_index_of(key);
-		if (is_slot_occupied(m_metadata_bucket[index]))
-			return iterator{ m_bucket + index, this };
+		if (hash_map_pair_t* pair = find_pair(key))
+			return iterator{ pair, this };
 
 		return end();
 	}
 	// finds the element with a certain key
-	citerator find(const key_t& key) const
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	citerator find(const key_arg_t& key) const
 	{
-		KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
-
-		const size_t index = find_index_of(key);
-		if (is_slot_occupied(m_metadata_bucket[index]))
-			return citerator{ m_bucket + index, this };
+		if (const hash_map_pair_t* pair = find_pair(key))
+			return citerator{ pair, this };
 
 		return cend();
 	}
 	// check if a key is contained within the map
-	bool contains(const key_t& key) const;
+	inline bool contains(const key_t& key) const { return contains<key_t>(key); }
+	// check if a key is contained within the map
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	bool contains(const key_arg_t& key) const { return find_pair(key) != nullptr; }
+	// find a batch of keys, writing a pointer to each key's value (or nullptr if it is missing) to out
+	// keys are hashed and their metadata and slots prefetched in batches, which hides memory latency on large maps
+	void find_many(const key_t* keys, const size_t count, value_t** out);
+	// find a batch of keys, writing a pointer to each key's value (or nullptr if it is missing) to out
+	void find_many(const key_t* keys, const size_t count, const value_t** out) const;
+	// check whether each key in a batch is contained within the map, writing the results to out
+	void contains_many(const key_t* keys, const size_t count, bool* out) const;
+#ifdef __cpp_lib_span
+	// find a batch of keys, out must be at least as large as keys
+	inline void find_many(std::span<const key_t> keys, std::span<value_t*> out)
+	{
+		KB_CORE_ASSERT(out.size() >= keys.size(), "output span is smaller than the key span");
+		find_many(keys.data(), keys.size(), out.data());
+	}
+	// find a batch of keys, out must be at least as large as keys
+	inline void find_many(std::span<const key_t> keys, std::span<const value_t*> out) const
+	{
+		KB_CORE_ASSERT(out.size() >= keys.size(), "output span is smaller than the key span");
+		find_many(keys.data(), keys.size(), out.data());
+	}
+	// check whether each key in a batch is contained within the map, out must be at least as large as keys
+	inline void contains_many(std::span<const key_t> keys, std::span<bool> out) const
+	{
+		KB_CORE_ASSERT(out.size() >= keys.size(), "output span is smaller than the key span");
+		contains_many(keys.data(), keys.size(), out.data());
+	}
+#endif
+	// number of metadata groups probed to find a key, or to prove it is missing
+	// useful to inspect clustering of a hash function on a specific key set, only looks at the current bucket
+	size_t get_probe_length(const key_t& key) const;
+	// snapshot of the occupancy of the map, plus its probing and rebuild counters when KB_FLAT_HASH_MAP_STATS is enabled
+	details::hash_map_stats stats() const;
+	// zero the probing and rebuild counters, does nothing when KB_FLAT_HASH_MAP_STATS is disabled
+	inline void reset_stats() { KB_FLAT_HASH_MAP_STATS_ONLY(m_stats.reset();) }
 
 	// =========
 	// iterators
@@ -523,70 +1400,303 @@ public:
 	// iterator pointing to the end of the map
 	iterator end() { return iterator{ nullptr, this }; }
 	// const iterator pointing to the beginning of the map
+	citerator begin() const { return cbegin(); }
+	// const iterator pointing to the end of the map
+	citerator end() const { return cend(); }
+	// const iterator pointing to the beginning of the map
 	citerator cbegin() const { return citerator{ m_bucket, this }; }
 	// iterator pointing to the end of the map
 	citerator cend() const { return citerator{ nullptr, this }; }
+	// call a function on every pair in the map, faster than iterating since whole metadata groups are scanned at once
+	// the function must not insert into or erase from the map
+	template <typename function_t>
+	void for_each(function_t&& function);
+	// call a function on every pair in the map, faster than iterating since whole metadata groups are scanned at once
+	template <typename function_t>
+	void for_each(function_t&& function) const;
 private:
+	// slot returned by find_or_prepare_insert
+	struct insert_slot_t
+	{
+		// index of the found key, or of the free slot to construct the pair in
+		size_t index;
+		// full hash of the key, used for the metadata (and the stored hash) when a pair is constructed
+		hash_t hash_value;
+		// whether the key is already in the map
+		bool found;
+	};
+
+	// first occupied pair at or after a pair in iteration order (the bucket, then the bucket an incremental rebuild is migrating)
+	// returns nullptr when there is none
+	inline hash_map_pair_t* find_occupied_pair_from(const hash_map_pair_t* pair_ptr) const;
+	// index of the first occupied slot at or after an index of a metadata bucket, or the bucket size when there is none
+	static inline size_t find_next_occupied_index(const metadata_t* metadata_bucket, const size_t max_elements, const size_t index);
+	// call visit(index) for every occupied slot of a metadata bucket
+	template <typename visit_t>
+	static inline void visit_occupied_slots(const metadata_t* metadata_bucket, const size_t max_elements, visit_t&& visit);
+	// find the pair of every key in a batch, calling resolve(key position, pair pointer or nullptr) for each key in order
+	template <typename resolve_t>
+	inline void find_pairs_of_many(const key_t* keys, const size_t count, resolve_t&& resolve) const;
+	// find the pairs of at most s_lookup_batch_size keys, get_key(i) returns key i
+	// every key is hashed and its metadata and first candidate slot prefetched before any key is compared
+	// calls resolve(i, pair pointer or nullptr) for each key in order
+	template <typename get_key_t, typename resolve_t>
+	inline void find_pairs_of_batch(const size_t batch_count, get_key_t&& get_key, resolve_t&& resolve) const;
+	// insert a forward range, prefetching the home groups of a batch of keys before any of them is probed
+	// get_key(element) returns the key of an element, construct(index, hash_value, element) constructs an element in a free slot
+	// elements whose key is already in the map are skipped
+	template <typename iterator_t, typename get_key_t, typename construct_t>
+	inline void insert_many(iterator_t first, iterator_t last, get_key_t&& get_key, construct_t&& construct);
+	// the lookup helpers below take the key as key_arg_t, which is key_t or, for heterogeneous lookups, any type the
+	// transparent hasher and key equality accept
+	// compute the full 64 bit hash of a key using the map's hasher
+	template <typename key_arg_t>
+	inline hash_t hash_key(const key_arg_t& key) const { return static_cast<hash_t>(m_hasher(key)); }
+	// find a key in the bucket, or in the bucket an incremental rebuild is migrating, returns nullptr if it is missing
+	template <typename key_arg_t>
+	inline hash_map_pair_t* find_pair(const key_arg_t& key) const { return find_pair(key, hash_key(key)); }
+	// find a key whose full hash is already known, returns nullptr if it is missing
+	template <typename key_arg_t>
+	inline hash_map_pair_t* find_pair(const key_arg_t& key, const hash_t hash_value) const;
+	// find a key in the bucket an incremental rebuild is migrating, returns nullptr if it is missing or there is no rebuild
+	template <typename key_arg_t>
+	inline hash_map_pair_t* find_pair_in_rebuild_source(const hash_t h1_hash, const h2_t h2_hash, const key_arg_t& key) const;
 	// find the index of the bucket where a key lives if present
 	inline size_t find_index_of(const key_t& key) const;
 	// find the index into the pair bucket where a key lives
-	inline size_t find_index_of(const hash_t h1_hash, const h2_t h2_hash, const K& key) const;
+	template <typename key_arg_t>
+	inline size_t find_index_of(const hash_t h1_hash, const h2_t h2_hash, const key_arg_t& key) const
+	{
+		return find_index_in(m_metadata_bucket, m_bucket, m_hash_bucket, get_capacity_mask(), h1_hash, h2_hash, key);
+	}
+	// find the index of a key in a specific bucket, or the index of the empty slot that stopped probing if it is missing
+	template <typename key_arg_t>
+	inline size_t find_index_in(
+		const metadata_t* metadata_bucket, 
+		const hash_map_pair_t* bucket, 
+		const hash_t* hash_bucket, 
+		const size_t capacity_mask, 
+		const hash_t h1_hash, 
+		const h2_t h2_hash, 
+		const key_arg_t& key
+	) const;
+	// find the first free (empty or deleted) index in the probe sequence of a hash, without comparing keys
+	inline size_t find_insert_index_of(const hash_t h1_hash) const;
 	// check if a metadata slot is occupied
 	inline bool is_slot_occupied(const metadata_t metadata) const { return metadata.is_slot_occupied(); }
 	// check if a metadata slot is empty
 	inline bool is_slot_empty(const metadata_t metadata) const { return metadata.is_slot_empty(); }
-	// re-allocate a larger array, move old map's values, and free old map
-	inline void rebuild();
-	// checks if the load factor has been reached, and a rebuild is necessary
-	inline void check_if_needs_rebuild() 
-	{ 
-		// #TODO should load factor and casting be doubles so we don't overflow?
-		if (m_element_count + 1 >= static_cast<uint64_t>(static_cast<float>(m_max_elements) * m_load_factor))
+	// construct a pair in-place in an unoccupied slot and mark the slot as occupied
+	// hash_value must be the full hash of the key, its h2 is stored in the metadata (and the full hash when StoreHash is set)
+	template <typename... Args>
+	inline hash_map_pair_t& construct_pair_at(const size_t index, const hash_t hash_value, Args&&... args)
+	{
+		hash_map_pair_t* pair_ptr = new (m_bucket + index) hash_map_pair_t(std::forward<Args>(args)...);
+		set_metadata(index, metadata_t{ static_cast<uint8_t>(metadata_t::occupied_bit_flag | metadata_t::get_h2_hash(hash_value)) });
+		if constexpr (s_store_hash)
+			m_hash_bucket[index] = hash_value;
+		return *pair_ptr;
+	}
+	// full hash of the key in an occupied slot of a bucket
+	// read back when the map stores hashes, otherwise the key is hashed again
+	inline hash_t get_slot_hash(const hash_map_pair_t* bucket, const hash_t* hash_bucket, const size_t index) const
+	{
+		if constexpr (s_store_hash)
+			return hash_bucket[index];
+		else
+			return hash_key(get_slot_key(bucket[index]));
+	}
+	// mark an occupied slot as free
+	// if the slot's group still has an empty slot, the group was never full, so no probe sequence ever continued past it
+	// and the slot can be marked empty, otherwise a tombstone is required so probing does not stop early
+	inline void erase_metadata_at(const size_t index)
+	{
+		const group_t group{ m_metadata_bucket + (index & ~(s_metadata_count_to_check - 1)) };
+		if (group.match_empty())
+			set_metadata(index, metadata_t{ metadata_t::empty_bit_flag });
+		else
 		{
-#ifdef KB_DEBUG
-			KB_CORE_INFO(
-				"[flat_unordered_hash_map]: triggering rebuild, {} >= {}",
-				m_element_count + 1,
-				static_cast<uint64_t>(static_cast<float>(m_max_elements) * m_load_factor)
-			);
-#endif
-			rebuild();
+			set_metadata(index, metadata_t{ metadata_t::deleted_bit_flag });
+			++m_deleted_count;
 		}
 	}
-	// use sse2 instructions to perform 16 masked lookups at once
-	// based on swiss table implementation details https://abseil.io/about/design/swisstables
-	// the metadata buffer is a pointer to 16 metadata elements (each being 8 bytes, making up a total of 128 bits)
-	inline mask_t find_matches_sse2(const h2_t h2_hash, const metadata_t* metadata_buffer) const
+	// destroy the pair of an occupied slot, metadata is left untouched
+	inline void destroy_pair_at(const size_t index) { m_bucket[index].~hash_map_pair_t(); }
+	// erase the entry of an occupied slot of the bucket
+	inline void erase_at(const size_t index)
 	{
-		// 16 metadata elements are loaded into register
-		// for _mm_load_si128(), the data needs to be 16 byte aligned 
-		// _mm_loadu_si128 has potentially worse performance but data does not need to be aligned
-		__m128i metadata = _mm_loadu_si128((__m128i*)metadata_buffer);
-		// #TODO document what this does
-		__m128i match = _mm_set1_epi8(h2_hash);
-		// #TODO document what this does
-		return static_cast<mask_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(match, metadata)));
+		destroy_pair_at(index);
+		erase_metadata_at(index);
+		--m_element_count;
+	}
+	// destroy the pairs of every occupied slot
+	inline void destroy_pairs();
+	// allocate the metadata and pair buckets for a specific size as a single cache line aligned block
+	// pairs are left uninitialized, metadata is initialized to an "empty" state
+	inline void allocate_buckets(const size_t max_elements);
+	// free a block allocated with allocate_buckets, every pair must already be destroyed
+	// the block starts with the metadata bucket
+	inline void deallocate_buckets(metadata_t* metadata_bucket, const size_t max_elements);
+	// byte offset of the pair bucket in the block, the pair bucket starts on a cache line after the metadata
+	static constexpr size_t get_pair_bucket_offset(const size_t max_elements) { return block_layout_t::get_pair_bucket_offset(max_elements); }
+	// byte offset of the stored hash bucket in the block, directly after the pair bucket
+	static constexpr size_t get_hash_bucket_offset(const size_t max_elements) { return block_layout_t::get_hash_bucket_offset(max_elements); }
+	// number of cache lines in the block for a specific size
+	static constexpr size_t get_block_line_count(const size_t max_elements) { return block_layout_t::get_line_count(max_elements); }
+	// whether a metadata bucket is the start of this map's inline block
+	inline bool is_inline_block(const metadata_t* metadata_bucket) const
+	{
+		if constexpr (s_inline_max_elements > 0)
+			return metadata_bucket == reinterpret_cast<const metadata_t*>(this->get_inline_lines());
+		else
+			return false;
 	}
+	// whether the bucket, or the old bucket of a running incremental rebuild, lives in this map's inline block
+	inline bool uses_inline_block() const { return is_inline_block(m_metadata_bucket) || is_inline_block(m_rebuild_source.metadata_bucket); }
+	// point the map at the shared empty group, an empty map without a bucket
+	inline void reset_to_unallocated()
+	{
+		m_bucket = nullptr;
+		m_metadata_bucket = details::s_empty_metadata_group.m_data;
+		m_hash_bucket = nullptr;
+		m_element_count = 0;
+		m_deleted_count = 0;
+		m_max_elements = s_metadata_count_to_check;
+	}
+	// take over the bucket of another map, this map must be unallocated and the other map is left unallocated
+	// a bucket in the other map's inline block cannot be taken over, its entries are moved into this map instead
+	inline void take_bucket(flat_unordered_hash_map& other);
+	// place count entries into the current bucket, which must be empty and large enough for all of them, using several threads
+	// get_hash(i) and get_key(i) may be called for entry i from any thread, construct(index, hash_value, i) constructs entry i in a free slot
+	// an entry whose key was already placed is skipped, so the first of several equal keys is kept
+	template <typename get_hash_t, typename get_key_t, typename construct_t>
+	inline void place_parallel(const size_t count, size_t thread_count, get_hash_t&& get_hash, get_key_t&& get_key, construct_t&& construct);
+	// indices of every occupied slot of a metadata bucket in ascending order, gathered with several threads
+	inline std::vector<size_t> get_occupied_indices(const metadata_t* metadata_bucket, const size_t max_elements, size_t thread_count) const;
+	// re-allocate a larger array, move old map's values, and free old map
+	inline void rebuild();
+	// re-allocate the arrays with a specific (power of two) size, move old map's values, and free old map
+	inline void rebuild(const size_t new_max_elements);
+	// set the metadata of a slot
+	inline void set_metadata(const size_t index, const metadata_t metadata) { m_metadata_bucket[index] = metadata; }
+	// mask used instead of modulus to wrap an index into the bucket, max elements is always a power of two
+	inline size_t get_capacity_mask() const { return m_max_elements - 1; }
+	// round a requested element count up to a valid bucket size (power of two, at least one group)
+	static inline size_t normalize_max_elements(const size_t requested_max_elements);
+
+	// maximum number of occupied and deleted slots before the map needs to rehash
+	inline size_t get_max_load() const { return static_cast<size_t>(static_cast<float>(m_max_elements) * m_load_factor); }
+	// find the index of a key, or a free slot to insert it into when the key is not in the map
+	// the free slot is neither constructed nor marked as occupied yet, the map may rehash to make room for it
+	template <typename key_arg_t>
+	inline insert_slot_t find_or_prepare_insert(const key_arg_t& key) { return find_or_prepare_insert(key, hash_key(key)); }
+	// find the index of a key with a precomputed hash, or a free slot to insert it into
+	template <typename key_arg_t>
+	inline insert_slot_t find_or_prepare_insert(const key_arg_t& key, const hash_t hash_value);
+	// find a free slot for a hash that is not in the map, rehashing first if the slot would exceed the max load
+	inline size_t prepare_insert(const hash_t hash_value);
+	// make room for an insertion, either by dropping deleted slots in-place or by doubling the bucket size
+	inline void rehash_and_grow_if_necessary();
+	// rehash every entry in the current bucket, turning all deleted slots back into empty slots without re-allocating
+	inline void drop_deleted_without_rebuild();
+	// allocate a new bucket and keep the current one as the source of an incremental rebuild
+	inline void start_incremental_rebuild(const size_t new_max_elements);
+	// make progress on a running incremental rebuild before a key is modified
+	// the key itself is moved first, so modifications only ever have to look at the new bucket
+	template <typename key_arg_t>
+	inline void continue_incremental_rebuild(const key_arg_t& key, const hash_t hash_value);
+	// move every occupied slot of the next group_count metadata groups to the new bucket
+	inline void migrate_groups(size_t group_count);
+	// move an occupied slot of the old bucket to the new bucket
+	inline void migrate_slot(const size_t old_index);
+	// move every remaining entry of a running incremental rebuild at once
+	inline void finish_incremental_rebuild() { if (m_rebuild_source.bucket) migrate_groups(m_rebuild_source.max_elements); }
+	// destroy any entries left in the old bucket of an incremental rebuild, and free it
+	inline void destroy_rebuild_source();
 private:
-	// default size of map
-	static constexpr const size_t s_default_max_elements = 1024ull;
+	// bucket that is being migrated by an incremental rebuild
+	struct rebuild_source_t
+	{
+		// pair bucket of the old block, nullptr when there is no rebuild running
+		hash_map_pair_t* bucket = nullptr;
+		// metadata bucket, start of the old block, migrated slots are marked as deleted
+		metadata_t* metadata_bucket = nullptr;
+		// stored hashes of the old block, only when StoreHash is set
+		hash_t* hash_bucket = nullptr;
+		// bucket size of the old block
+		size_t max_elements = 0ull;
+		// number of entries left in the old block
+		size_t element_count = 0ull;
+		// index of the next metadata group to migrate
+		size_t migrated_index = 0ull;
+	};
+
+	// number of keys hashed and prefetched together by the batched lookups
+	// large enough to keep many cache misses in flight, small enough that prefetched lines are not evicted before use
+	static constexpr const size_t s_lookup_batch_size = 16ull;
+	// minimum number of entries each thread of a parallel build gets, below this starting threads costs more than it saves
+	static constexpr const size_t s_parallel_min_entries_per_thread = 16384ull;
+	// default number of entries a map needs before set_parallel_rebuild starts using threads
+	static constexpr const size_t s_default_parallel_rebuild_min_elements = 1ull << 20;
+	// number of slots of the pair bucket staged at once while saving a snapshot, a multiple of every group width
+	static constexpr const size_t s_snapshot_chunk_size = 4096ull;
+	// whether the full hash of each key is stored, so keys never have to be rehashed when the map is rebuilt
+	// worth it for keys that are expensive to hash or compare (e.g. long strings), costs 8 bytes per slot
+	static constexpr const bool s_store_hash = StoreHash;
 	// count of metadata that simd instructions can simultaneously check
-	static constexpr const size_t s_metadata_count_to_check = 16ull;
+	static constexpr const size_t s_metadata_count_to_check = group_t::s_width;
+	// number of entries kept in-object before the map spills to the heap, 0 keeps every bucket on the heap
+	static constexpr const size_t s_inline_capacity = InlineCapacity;
+	// size of the bucket in the inline block, 0 without inline capacity
+	static constexpr const size_t s_inline_max_elements = InlineCapacity > 0 ? details::get_inline_max_elements(InlineCapacity) : 0ull;
+	// size of the bucket allocated by the first insertion, maps allocate nothing until then
+	static constexpr const size_t s_default_max_elements = InlineCapacity > 0 ? s_inline_max_elements : s_metadata_count_to_check;
 	// count of elements in the map
 	size_t m_element_count = 0ull;
-	// maximum size of the bucket before re-allocation
-	size_t m_max_elements = s_default_max_elements;
-	// percentage the bucket can be filled before re-allocation
+	// count of deleted slots (tombstones) in the map, they count against the load factor since they lengthen probing
+	size_t m_deleted_count = 0ull;
+	// maximum size of the bucket before re-allocation, always a power of two
+	// an unallocated map uses the size of the shared empty group
+	size_t m_max_elements = s_metadata_count_to_check;
+	// percentage the bucket can be filled (including deleted slots) before re-allocation or an in-place rehash
 	float m_load_factor = 0.875f;
 	// contiguous array of hash map pairs
+	// lives in the same allocation as the metadata bucket, starting on the first cache line after it
 	hash_map_pair_t* m_bucket = nullptr;
-	// contiguous array of hash map metadata
-	metadata_t* m_metadata_bucket = nullptr;
-	// 16 byte array to store contiguous metadata when lookup index >= m_max_elements - 15
-	metadata_t* m_temporary_metadata_bucket = nullptr;
+	// contiguous array of hash map metadata, start of the allocated block
+	// laid out as [m_max_elements slots][sentinel]
+	// points at the shared empty group until the map allocates a bucket
+	metadata_t* m_metadata_bucket = details::s_empty_metadata_group.m_data;
+	// contiguous array of the full hash of each occupied slot, only allocated when StoreHash is set
+	// lives in the same allocation, right after the pair bucket
+	hash_t* m_hash_bucket = nullptr;
+	// allocator for the combined metadata and pair block
+	block_allocator_t m_allocator{};
+	// old bucket while an incremental rebuild is running
+	rebuild_source_t m_rebuild_source{};
+	// number of metadata groups migrated per insert or erase during an incremental rebuild, 0 rebuilds all at once
+	size_t m_incremental_rebuild_group_count = 0ull;
+	// number of threads used by rebuilds of large maps, 1 rebuilds on the calling thread
+	size_t m_rebuild_thread_count = 1ull;
+	// number of entries before rebuilds use m_rebuild_thread_count threads
+	size_t m_parallel_rebuild_min_elements = s_default_parallel_rebuild_min_elements;
+	// hash function used to compute h1 and h2 hashes
+	hasher_t m_hasher{};
+	// equality function used to compare candidate keys
+	key_equal_t m_key_equal{};
+	// probing and rebuild counters, bumped by const lookups as well
+	KB_FLAT_HASH_MAP_STATS_ONLY(mutable details::stats_counters m_stats{};)
 	// friend declarations
 	friend class iterator;
 	friend class citerator;
+	template <typename, typename, typename, typename, bool>
+	friend class flat_unordered_hash_set;
+	template <typename, typename, typename, typename, typename, bool>
+	friend class node_unordered_hash_map;
+	template <typename, typename, typename, typename, typename, bool>
+	friend class split_flat_unordered_hash_map;
+	template <typename, typename, size_t, typename, typename, typename, typename>
+	friend class sharded_flat_hash_map;
 };
 
 // ============================
@@ -594,159 +1704,183 @@ private:
 // ============================
 
 // default constructor
-// pair bucket is not initialized, while the metadata bucket is
-// metadata_t has a default constructor which initializes the metadata to an "empty" state
-template <typename K, typename V>
-flat_unordered_hash_map<K, V>::flat_unordered_hash_map()
-	: m_bucket{ new hash_map_pair_t[m_max_elements]{} }, m_metadata_bucket{ new metadata_t[m_max_elements]{} }, 
-	m_temporary_metadata_bucket{ new metadata_t[s_metadata_count_to_check] }
+// nothing is allocated, the bucket is allocated by the first insertion
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::flat_unordered_hash_map()
+{
+
+}
+
+// constructor with a custom allocator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::flat_unordered_hash_map(const allocator_t& allocator)
+	: m_allocator{ allocator }
+{
+
+}
+
+// constructor with a custom hash, key equality function, and allocator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::flat_unordered_hash_map(const hasher_t& hasher, const key_equal_t& key_equal, const allocator_t& allocator)
+	: m_allocator{ allocator }, m_hasher{ hasher }, m_key_equal{ key_equal }
 {
 
 }
 
 // copy constructor for hash map with the same key and value type
-template <typename K, typename V>
-flat_unordered_hash_map<K, V>::flat_unordered_hash_map(const flat_unordered_hash_map& other)
-	: m_bucket{ new hash_map_pair_t[m_max_elements]{} }, m_metadata_bucket{ new metadata_t[m_max_elements]{} },
-	m_temporary_metadata_bucket{ new metadata_t[s_metadata_count_to_check] }
+// the bucket is allocated with the same size as the other map, so metadata (including the sentinel) can be copied as is
+// a copy of an unallocated map is unallocated as well
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::flat_unordered_hash_map(const flat_unordered_hash_map& other)
+	: m_element_count{ other.m_element_count }, m_deleted_count{ other.m_deleted_count }, m_load_factor{ other.m_load_factor },
+	m_allocator{ block_allocator_traits_t::select_on_container_copy_construction(other.m_allocator) },
+	m_incremental_rebuild_group_count{ other.m_incremental_rebuild_group_count },
+	m_rebuild_thread_count{ other.m_rebuild_thread_count }, m_parallel_rebuild_min_elements{ other.m_parallel_rebuild_min_elements },
+	m_hasher{ other.m_hasher }, m_key_equal{ other.m_key_equal }
 {
-	// reserve more space if needed
-	if (other.max_size() > max_size())
-		reserve(other.max_size());
+	if (!other.m_bucket)
+		return;
+
+	allocate_buckets(other.m_max_elements);
+
+	// copy metadata
+	std::copy_n(other.m_metadata_bucket, m_max_elements + 1, m_metadata_bucket);
+
+	// copy stored hashes, only occupied slots are ever read
+	if constexpr (s_store_hash)
+		std::copy_n(other.m_hash_bucket, m_max_elements, m_hash_bucket);
 
-	// do we need to go through every element and copy? could we just iterate through valid keys?
-	// copy pairs and metadata
+	// copy construct occupied pairs
 	for (size_t i = 0; i < m_max_elements; ++i)
+		if (is_slot_occupied(other.m_metadata_bucket[i]))
+			new (m_bucket + i) hash_map_pair_t(other.m_bucket[i]);
+
+	// entries the other map has not migrated yet go straight into the bucket, the load check already counts them
+	const rebuild_source_t& source = other.m_rebuild_source;
+	if (source.bucket)
 	{
-		m_bucket[i] = other.m_bucket[i];
-		m_metadata_bucket = other.m_metadata_bucket[i];
-	}
+		visit_occupied_slots(source.metadata_bucket, source.max_elements, [this, &other, &source](const size_t index)
+			{
+				const hash_t hash_value = other.get_slot_hash(source.bucket, source.hash_bucket, index);
+				const size_t new_index = find_insert_index_of(metadata_t::get_h1_hash(hash_value));
+				if (m_metadata_bucket[new_index].is_slot_deleted())
+					--m_deleted_count;
 
-	m_max_elements = other.m_max_elements;
-	m_element_count = other.m_element_count;
-	m_load_factor = other.m_load_factor;
+				construct_pair_at(new_index, hash_value, source.bucket[index]);
+			}
+		);
+	}
 }
 
 // move constructor for hash map with the same key and value type
-template <typename K, typename V>
-flat_unordered_hash_map<K, V>::flat_unordered_hash_map(flat_unordered_hash_map&& other) noexcept
+// takes ownership of the other map's block, leaving the other map empty and unallocated
+// entries in the other map's inline block are moved one by one
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::flat_unordered_hash_map(flat_unordered_hash_map&& other) noexcept
+	: m_load_factor{ other.m_load_factor }, m_allocator{ std::move(other.m_allocator) },
+	m_incremental_rebuild_group_count{ other.m_incremental_rebuild_group_count },
+	m_rebuild_thread_count{ other.m_rebuild_thread_count }, m_parallel_rebuild_min_elements{ other.m_parallel_rebuild_min_elements },
+	m_hasher{ std::move(other.m_hasher) }, m_key_equal{ std::move(other.m_key_equal) }
 {
-	// swap contents with other map
-	swap(other);
+	take_bucket(other);
 }
 
 // destructor
-template <typename K, typename V>
-flat_unordered_hash_map<K, V>::~flat_unordered_hash_map()
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::~flat_unordered_hash_map()
 {
-	if (m_bucket)
-		delete[] m_bucket;
-#if KB_DEBUG
-	// we should never have an invalid pointer
-	else
-		KB_CORE_ASSERT(false, "tried deleting invalid bucket pointer?");
-#endif
-
-	if (m_metadata_bucket)
-		delete[] m_metadata_bucket;
-#if KB_DEBUG
-	// we should never have an invalid pointer
-	else
-		KB_CORE_ASSERT(false, "tried deleting invalid metadata pointer?");
-#endif
-
-	if (m_temporary_metadata_bucket)
-		delete[] m_temporary_metadata_bucket;
+	destroy();
 }
 
 // copy assign operator
-template <typename K, typename V>
-flat_unordered_hash_map<K, V>& flat_unordered_hash_map<K, V>::operator=(const flat_unordered_hash_map& other)
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>& flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::operator=(const flat_unordered_hash_map& other)
 {
-	*this = flat_unordered_hash_map<K, V>{ other };
+	if (this != &other)
+		*this = flat_unordered_hash_map{ other };
+
+	return *this;
 }
 
 // move assign operator
-template <typename K, typename V>
-flat_unordered_hash_map<K, V>& flat_unordered_hash_map<K, V>::operator=(flat_unordered_hash_map&& other) noexcept
+// the block can only be stolen if the allocator propagates or both allocators are equal (e.g. same memory resource)
+// otherwise every pair is moved into memory from this map's allocator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>& flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::operator=(flat_unordered_hash_map&& other) noexcept
 {
-	swap(other);
-}
+	if (this == &other)
+		return *this;
 
-// free memory and invalid the map
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::destroy()
-{
-	if (m_bucket)
-		delete[] m_bucket;
+	if constexpr (!block_allocator_traits_t::propagate_on_container_move_assignment::value)
+	{
+		if (m_allocator != other.m_allocator)
+		{
+			clear_entries();
+			other.finish_incremental_rebuild();
+			if (m_max_elements < other.m_max_elements)
+				rebuild(other.m_max_elements);
 
-	if (m_metadata_bucket)
-		delete[] m_metadata_bucket;
+			for (size_t i = 0; i < other.m_max_elements; ++i)
+				if (is_slot_occupied(other.m_metadata_bucket[i]))
+					insert(std::move(other.m_bucket[i]));
 
-	m_bucket = nullptr;
-	m_element_count = 0;
-	m_max_elements = 0;
+			other.clear_entries();
+			return *this;
+		}
+	}
+
+	swap(other);
+
+	return *this;
 }
 
-// clear all the entries from the map
-// frees current bucket, resizing to default size
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::clear()
+// destroy all entries and free memory, leaving the map empty and unallocated
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::destroy()
 {
-	// #TODO there are most likely optimizations to be made here...
-
-	// free pairs
 	if (m_bucket)
-		delete[] m_bucket;
-
-	// free metadata
-	if (m_metadata_bucket)
-		delete[] m_metadata_bucket;
+	{
+		destroy_pairs();
+		deallocate_buckets(m_metadata_bucket, m_max_elements);
+	}
+	destroy_rebuild_source();
 
-	// resize arrays to default size
-	m_bucket = new hash_map_pair_t[s_default_max_elements]{};
-	m_metadata_bucket = new metadata_t[s_default_max_elements]{};
-	m_element_count = 0;
-	m_max_elements = s_default_max_elements;
+	reset_to_unallocated();
 }
 
 // clear all the entries from the map
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::clear_entries()
+// frees the current bucket, the next insertion allocates a bucket of the default size
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::clear()
 {
-	// #TODO like the clear function above, there are optimizations to be made...
+	destroy();
+}
 
-	// clear pair data
+// clear all the entries from the map, keeping the current bucket size
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::clear_entries()
+{
+	// destroy pair data, and drop the old bucket of a running incremental rebuild
 	if (m_bucket)
-		for (size_t i = 0; i < m_max_elements; ++i)
-			m_bucket[i] = hash_map_pair_t{};
+		destroy_pairs();
+	destroy_rebuild_source();
 
-	// clear metadata
+	// clear metadata, but not the sentinel
+	// the shared empty group of an unallocated map is never written
 	if (m_bucket)
-		for (size_t i = 0; i < m_max_elements; ++i)
-			m_metadata_bucket[i] = metadata_t{};
+		std::fill_n(m_metadata_bucket, m_max_elements, metadata_t{});
 
 	m_element_count = 0;
+	m_deleted_count = 0;
 }
 
 // insert element into the map. *safely* fails if the key is already present
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::insert(const hash_map_pair_t& pair)
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::insert(const hash_map_pair_t& pair)
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
-
-	// rebuild the map if we are getting too full
-	check_if_needs_rebuild();
-	
-	// compute general hash, and mask out h1 and h2 hashes
-	const hash_t hash_value = hash::generate_u64_fnv1a_hash(key);
-	const hash_t h1_hash = hash_value & metadata_t::h1_hash_mask;
-	const h2_t h2_hash = static_cast<h2_t>((hash_value & metadata_t::h2_hash_mask) >> 0x39);
-	const size_t index = find_index_of(h1_hash, h2_hash, key);
-
-	metadata_t& metadata = m_metadata_bucket[index];
+	const insert_slot_t slot = find_or_prepare_insert(pair.key);
 	// *safely* fail if the slot is occupied
-	if (metadata.is_slot_occupied())
+	if (slot.found)
 	{
 #ifdef KB_DEBUG
 		KB_CORE_ASSERT(false, "tried inserting but key was already present")
@@ -754,325 +1888,1000 @@ void flat_unordered_hash_map<K, V>::insert(const hash_map_pair_t& pair)
 		return;
 	}
 
-	// copy pair data
-	m_bucket[index] = pair;
-	// set metadata
-	m_metadata_bucket[index] = (metadata_t::occupied_bit_flag | h2_hash);
+	// copy construct in bucket memory
+	construct_pair_at(slot.index, slot.hash_value, pair);
 	++m_element_count;
+}
 
-#if 0
-	hash_map_pair_t& found_pair = m_bucket[find_index_of(pair.key)];
-	if (is_slot_occupied(found_pair))
+// insert element into the map. *safely* fails if the key is already present
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::insert(hash_map_pair_t&& pair)
+{
+	const insert_slot_t slot = find_or_prepare_insert(pair.key);
+	// *safely* fail if the slot is occupied
+	if (slot.found)
 	{
 #ifdef KB_DEBUG
 		KB_CORE_ASSERT(false, "tried inserting but key was already present")
 #endif
 		return;
 	}
-	
-	// #TODO should these values be moved?
-	found_pair = pair;
-	found_pair.flags |= hash_map_pair_t::occupied_bit_flag;
+
+	// move construct in bucket memory
+	construct_pair_at(slot.index, slot.hash_value, std::move(pair));
 	++m_element_count;
-#endif
 }
 
-// insert element into the map. *safely* fails if the key is already present
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::insert(hash_map_pair_t&& pair)
+// find the index of a key, or prepare a free slot to insert it into
+// the free slot is the first empty or deleted slot in the key's probe sequence, so tombstones are reused
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t>
+inline typename flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::insert_slot_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_or_prepare_insert(const key_arg_t& key, const hash_t hash_value)
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
+	// mask out h1 and h2 hashes
+	const hash_t h1_hash = metadata_t::get_h1_hash(hash_value);
+	const h2_t h2_hash = metadata_t::get_h2_hash(hash_value);
+
+	// after this the key can only be in the bucket
+	continue_incremental_rebuild(key, hash_value);
+
+	const size_t index = find_index_of(h1_hash, h2_hash, key);
+	if (is_slot_occupied(m_metadata_bucket[index]))
+		return insert_slot_t{ index, hash_value, true };
+
+	return insert_slot_t{ prepare_insert(hash_value), hash_value, false };
+}
+
+// find a free slot for a hash that is not in the map
+// reusing a deleted slot never changes the load, so only taking an empty slot can trigger a rehash
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline size_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::prepare_insert(const hash_t hash_value)
+{
+	const hash_t h1_hash = metadata_t::get_h1_hash(hash_value);
+
+	// the first insertion allocates the bucket, lookups until then probe the shared empty group
+	if (!m_bucket)
+	{
+		allocate_buckets(s_default_max_elements);
+		return find_insert_index_of(h1_hash);
+	}
+
+	size_t index = find_insert_index_of(h1_hash);
+	if (m_metadata_bucket[index].is_slot_deleted())
+	{
+		--m_deleted_count;
+		return index;
+	}
 
 	// rebuild the map if we are getting too full
-	check_if_needs_rebuild();
+	if (m_element_count + m_deleted_count + 1 >= get_max_load())
+	{
+		rehash_and_grow_if_necessary();
+		index = find_insert_index_of(h1_hash);
+	}
 
-	// compute general hash, and mask out h1 and h2 hashes
-	const hash_t hash_value = hash::generate_u64_fnv1a_hash(pair.key);
-	const hash_t h1_hash = hash_value & metadata_t::h1_hash_mask;
-	const h2_t h2_hash = static_cast<h2_t>((hash_value & metadata_t::h2_hash_mask) >> 0x39);
-	const size_t index = find_index_of(h1_hash, h2_hash, pair.key);
+	return index;
+}
 
-	metadata_t& metadata = m_metadata_bucket[index];
-	// *safely* fail if the slot is occupied
-	if (metadata.is_slot_occupied())
+// make room for one more insertion
+// when most of the load is tombstones, rehashing in-place is cheaper than doubling and keeps memory usage flat
+// for churn heavy workloads, same heuristic as absl: in-place if live elements are at most 25/32 of the bucket
+// (25/28 of the max load, for any load factor)
+// with incremental rebuilding enabled, the same decision picks the size of the new bucket instead
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::rehash_and_grow_if_necessary()
+{
+	// the new bucket of an incremental rebuild filled up before the migration finished (e.g. with a tiny group budget)
+	finish_incremental_rebuild();
+
+	const bool drop_deleted = m_deleted_count > 0 && m_element_count * 28 <= get_max_load() * 25;
+	if (m_incremental_rebuild_group_count > 0)
+	{
+		start_incremental_rebuild(drop_deleted ? m_max_elements : m_max_elements * 2);
+		return;
+	}
+
+	if (drop_deleted)
 	{
 #ifdef KB_DEBUG
-		KB_CORE_ASSERT(false, "tried inserting but key was already present")
+		KB_CORE_INFO("[flat_unordered_hash_map]: dropping {} deleted slots in-place", m_deleted_count);
 #endif
+		drop_deleted_without_rebuild();
 		return;
 	}
 
-	// pointer to where the pair will be move constructed
-	hash_map_pair_t* pair_ptr = m_bucket + index;
-	// move construct in bucket memory
-	// new (pair_ptr) hash_map_pair_t{ pair };
-	*pair_ptr = std::move(pair);
-	// set metadata
-	m_metadata_bucket[index] = metadata_t{ static_cast<uint8_t>(metadata_t::occupied_bit_flag | h2_hash) };
-	++m_element_count;
-#if 0
-	// rebuild the map if we are getting too full
-	check_if_needs_rebuild();
+#ifdef KB_DEBUG
+	KB_CORE_INFO(
+		"[flat_unordered_hash_map]: triggering rebuild, {} >= {}",
+		m_element_count + m_deleted_count + 1,
+		get_max_load()
+	);
+#endif
+	rebuild();
+}
+
+// rehash every entry without re-allocating, based on absl's DropDeletesWithoutResize
+//   1. mark every occupied slot as deleted (meaning "not placed yet"), and every deleted slot as empty
+//   2. for every slot marked deleted, find the first free slot in its probe sequence
+//      a. if that slot is in the same group, the entry is already reachable and stays
+//      b. if that slot is empty, move the entry there
+//      c. otherwise that slot holds an entry that is not placed yet, swap the two and process the swapped entry next
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::drop_deleted_without_rebuild()
+{
+	for (size_t i = 0; i < m_max_elements; ++i)
+		m_metadata_bucket[i] = metadata_t{ is_slot_occupied(m_metadata_bucket[i]) ? metadata_t::deleted_bit_flag : metadata_t::empty_bit_flag };
+
+	// temporary storage used to swap two pairs
+	alignas(hash_map_pair_t) uint8_t temporary_storage[sizeof(hash_map_pair_t)];
+	hash_map_pair_t* temporary_pair = reinterpret_cast<hash_map_pair_t*>(temporary_storage);
 
-	hash_map_pair_t* found_pair_ptr = m_bucket + find_index_of(pair.key);
-	if (is_slot_occupied(*found_pair_ptr))
+	for (size_t i = 0; i < m_max_elements; ++i)
 	{
+		if (!m_metadata_bucket[i].is_slot_deleted())
+			continue;
+
+		const hash_t hash_value = get_slot_hash(m_bucket, m_hash_bucket, i);
+		const size_t new_index = find_insert_index_of(metadata_t::get_h1_hash(hash_value));
+
+		// groups are aligned, so the same group is the same position in the probe sequence
+		if (new_index / s_metadata_count_to_check == i / s_metadata_count_to_check)
+		{
+			set_metadata(i, metadata_t{ static_cast<uint8_t>(metadata_t::occupied_bit_flag | metadata_t::get_h2_hash(hash_value)) });
+			continue;
+		}
+
+		if (is_slot_empty(m_metadata_bucket[new_index]))
+		{
+			// move to the free slot, and free the current slot
+			construct_pair_at(new_index, hash_value, std::move(m_bucket[i]));
+			destroy_pair_at(i);
+			set_metadata(i, metadata_t{ metadata_t::empty_bit_flag });
+		}
+		else
+		{
+			// swap with the entry that is not placed yet, then process the swapped entry in this slot again
+			new (temporary_pair) hash_map_pair_t(std::move(m_bucket[new_index]));
+			destroy_pair_at(new_index);
+			if constexpr (s_store_hash)
+				m_hash_bucket[i] = std::exchange(m_hash_bucket[new_index], hash_value);
+			construct_pair_at(new_index, hash_value, std::move(m_bucket[i]));
+			destroy_pair_at(i);
+			new (m_bucket + i) hash_map_pair_t(std::move(*temporary_pair));
+			temporary_pair->~hash_map_pair_t();
+			--i;
+		}
+	}
+
+	m_deleted_count = 0;
+}
+
+// find the pair of a key, checking the old bucket of a running incremental rebuild if it is not in the bucket
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t>
+inline typename flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::hash_map_pair_t* flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_pair(const key_arg_t& key, const hash_t hash_value) const
+{
+	const hash_t h1_hash = metadata_t::get_h1_hash(hash_value);
+	const h2_t h2_hash = metadata_t::get_h2_hash(hash_value);
+
+	const size_t index = find_index_of(h1_hash, h2_hash, key);
+	if (is_slot_occupied(m_metadata_bucket[index]))
+		return m_bucket + index;
+
+	return find_pair_in_rebuild_source(h1_hash, h2_hash, key);
+}
+
+// find a key in the old bucket of a running incremental rebuild
+// migrated slots are marked as deleted, so the old bucket still always has an empty slot to stop probing
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t>
+inline typename flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::hash_map_pair_t* flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_pair_in_rebuild_source(const hash_t h1_hash, const h2_t h2_hash, const key_arg_t& key) const
+{
+	const rebuild_source_t& source = m_rebuild_source;
+	if (source.element_count == 0)
+		return nullptr;
+
+	const size_t index = find_index_in(source.metadata_bucket, source.bucket, source.hash_bucket, source.max_elements - 1, h1_hash, h2_hash, key);
+	return is_slot_occupied(source.metadata_bucket[index]) ? source.bucket + index : nullptr;
+}
+
+// start an incremental rebuild, the current bucket becomes the old bucket that entries are migrated from
+// every entry is still counted by m_element_count, so the load check of the new bucket already accounts for them
+// and they always fit in the new bucket as long as it is not filled up first
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::start_incremental_rebuild(const size_t new_max_elements)
+{
+	KB_CORE_ASSERT(!m_rebuild_source.bucket, "an incremental rebuild is already running!");
+
 #ifdef KB_DEBUG
-		KB_CORE_ASSERT(false, "tried inserting but key was already present")
+	KB_CORE_INFO("[flat_unordered_hash_map]: starting incremental rebuild, {} -> {}", m_max_elements, new_max_elements);
 #endif
+
+	KB_FLAT_HASH_MAP_STATS_ONLY(m_stats.record_incremental_rebuild();)
+	m_rebuild_source = rebuild_source_t{ m_bucket, m_metadata_bucket, m_hash_bucket, m_max_elements, m_element_count, 0ull };
+	allocate_buckets(new_max_elements);
+	m_deleted_count = 0;
+
+	migrate_groups(m_incremental_rebuild_group_count);
+}
+
+// migrate the key about to be modified, plus a bounded number of groups so the rebuild always finishes
+// at least one group is migrated per operation, even if incremental rebuilding was disabled during the rebuild
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::continue_incremental_rebuild(const key_arg_t& key, const hash_t hash_value)
+{
+	if (!m_rebuild_source.bucket)
 		return;
+
+	if (const hash_map_pair_t* pair = find_pair_in_rebuild_source(metadata_t::get_h1_hash(hash_value), metadata_t::get_h2_hash(hash_value), key))
+		migrate_slot(static_cast<size_t>(pair - m_rebuild_source.bucket));
+
+	migrate_groups(std::max<size_t>(m_incremental_rebuild_group_count, 1));
+}
+
+// migrate the next groups of the old bucket in order, and free the old bucket once it is empty
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::migrate_groups(size_t group_count)
+{
+	rebuild_source_t& source = m_rebuild_source;
+	for (; group_count > 0 && source.element_count > 0 && source.migrated_index < source.max_elements; --group_count)
+	{
+		for (const size_t i : group_t{ source.metadata_bucket + source.migrated_index }.match_full())
+			migrate_slot(source.migrated_index + i);
+
+		source.migrated_index += s_metadata_count_to_check;
 	}
 
-	pair.flags |= hash_map_pair_t::occupied_bit_flag;
-	new (found_pair_ptr) hash_map_pair_t{ std::move(pair) }; // move construct in memory
-	++m_element_count;
-#endif
+	if (source.element_count == 0)
+		destroy_rebuild_source();
+}
+
+// move an entry from the old bucket to the first free slot of its probe sequence in the new bucket
+// the new bucket can have tombstones from erases during the rebuild, those are reused
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::migrate_slot(const size_t old_index)
+{
+	rebuild_source_t& source = m_rebuild_source;
+
+	const hash_t hash_value = get_slot_hash(source.bucket, source.hash_bucket, old_index);
+	const size_t index = find_insert_index_of(metadata_t::get_h1_hash(hash_value));
+	if (m_metadata_bucket[index].is_slot_deleted())
+		--m_deleted_count;
+
+	construct_pair_at(index, hash_value, std::move(source.bucket[old_index]));
+	source.bucket[old_index].~hash_map_pair_t();
+
+	// a tombstone keeps the probe sequences of entries left in the old bucket intact
+	source.metadata_bucket[old_index] = metadata_t{ metadata_t::deleted_bit_flag };
+	--source.element_count;
+}
+
+// destroy the entries left in the old bucket (if any) and free it
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::destroy_rebuild_source()
+{
+	rebuild_source_t& source = m_rebuild_source;
+	if (!source.bucket)
+		return;
+
+	if constexpr (!std::is_trivially_destructible_v<hash_map_pair_t>)
+		if (source.element_count > 0)
+			visit_occupied_slots(source.metadata_bucket, source.max_elements, [&source](const size_t index) { source.bucket[index].~hash_map_pair_t(); });
+
+	deallocate_buckets(source.metadata_bucket, source.max_elements);
+	source = rebuild_source_t{};
 }
 
 // helper function to compute an index from a key, when callee does not need to know h1 or h2 hash
-template <typename K, typename V>
-inline size_t flat_unordered_hash_map<K, V>::find_index_of(const K& key) const
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline size_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_index_of(const K& key) const
 {
 	// compute general hash, and mask out h1 and h2 hashes
-	const hash_t hash_value = hash::generate_u64_fnv1a_hash(key);
-	const hash_t h1_hash = hash_value & metadata_t::h1_hash_mask;
-	const h2_t h2_hash = static_cast<h2_t>((hash_value & metadata_t::h2_hash_mask) >> 0x39);
+	const hash_t hash_value = hash_key(key);
+	const hash_t h1_hash = metadata_t::get_h1_hash(hash_value);
+	const h2_t h2_hash = metadata_t::get_h2_hash(hash_value);
 	return find_index_of(h1_hash, h2_hash, key);
 }
 
 // find the index of the bucket where a key lives if present using open addressing. 
-// this uses a naive implementation of linear probing open addressing from https://en.wikipedia.org/wiki/Open_addressing
 // the steps of this swiss table lookup is as follows
-//   1. use the *h1 hash* to find the start of a "bucket chain" for that specific hash
+//   1. use the *h1 hash* to find the first group of a "bucket chain" for that specific hash
 //   2. use the *h2 hash* to create a mask
-//   3. use sse2 instructions and the mask to find candidate slots
+//   3. use simd instructions (sse2, avx2, or the portable fallback) and the mask to find candidate slots
 //   4. perform equality checks on all candidates
-//   5. if the check fails, start performing linear probing to generate a new "bucket chain" and repeat
+//   5. if the check fails, move to the next group of the triangular probe sequence and repeat
 //      a. an empty element stops probing
 //      b. a deleted element does not
-template <typename K, typename V>
-inline size_t flat_unordered_hash_map<K, V>::find_index_of(const hash_t h1_hash, const h2_t h2_hash, const K& key) const
+// groups are aligned to the group width, so a group never wraps around the end of the bucket
+// takes the bucket explicitly so the old bucket of an incremental rebuild can be searched the same way
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t>
+inline size_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_index_in(
+	const metadata_t* metadata_bucket, 
+	const hash_map_pair_t* bucket, 
+	const hash_t* hash_bucket, 
+	const size_t capacity_mask, 
+	const hash_t h1_hash, 
+	const h2_t h2_hash, 
+	const key_arg_t& key
+) const
+{
+	probe_sequence_t probe{ h1_hash, capacity_mask };
+	// full hash, compared against the stored hashes before the keys
+	const hash_t hash_value = h1_hash | (static_cast<hash_t>(h2_hash) << 0x39);
+	// h2 matches seen so far, all but the matching key are false positives
+	KB_FLAT_HASH_MAP_STATS_ONLY(size_t candidate_count = 0;)
+
+	// the load factor (which counts deleted slots) guarantees an empty slot, and the probe sequence visits every group,
+	// so this always terminates
+	while (true)
+	{
+		// use simd instructions to search for a group of potential candidates at once
+		const group_t group{ metadata_bucket + probe.get_offset() };
+
+		// equality check on all candidates, an h2 match is always an occupied slot
+		// when hashes are stored, an h2 false positive is almost always rejected without touching the key
+		for (const size_t i : group.match(h2_hash))
+		{
+			KB_FLAT_HASH_MAP_STATS_ONLY(++candidate_count;)
+			const size_t bucket_index = probe.get_offset(i);
+			if constexpr (s_store_hash)
+				if (hash_bucket[bucket_index] != hash_value)
+					continue;
+
+			if (m_key_equal(get_slot_key(bucket[bucket_index]), key))
+			{
+				KB_FLAT_HASH_MAP_STATS_ONLY(m_stats.record_lookup(probe.get_probe_length() + 1, candidate_count - 1);)
+				return bucket_index;
+			}
+		}
+
+		// an empty slot stops probing, the key is not in the map
+		if (const mask_t empty_slots = group.match_empty())
+		{
+			KB_FLAT_HASH_MAP_STATS_ONLY(m_stats.record_lookup(probe.get_probe_length() + 1, candidate_count);)
+			return probe.get_offset(empty_slots.lowest_index());
+		}
+
+		// otherwise continue probing, deleted slots do not stop probing
+		probe.next();
+	}
+}
+
+// batched lookup, split into three passes over each batch so the memory accesses of different keys overlap
+//   1. hash every key and prefetch the first metadata group of its probe sequence
+//   2. match h2 against the (hopefully cached) group and prefetch the first candidate slot
+//   3. resolve every key with the regular probing loop, which now mostly hits cache
+// the old bucket of a running incremental rebuild is only searched (without prefetching) for keys missing from the bucket
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename resolve_t>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_pairs_of_many(const key_t* keys, const size_t count, resolve_t&& resolve) const
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
+	for (size_t batch_begin = 0; batch_begin < count; batch_begin += s_lookup_batch_size)
+	{
+		const key_t* batch_keys = keys + batch_begin;
+		find_pairs_of_batch(std::min(count - batch_begin, s_lookup_batch_size), 
+			[batch_keys](const size_t i) -> const key_t& { return batch_keys[i]; },
+			[batch_begin, &resolve](const size_t i, hash_map_pair_t* pair) { resolve(batch_begin + i, pair); }
+		);
+	}
+}
+
+// find a batch of keys in three passes: hash and prefetch metadata, match h2 and prefetch the first candidate, then compare keys
+// get_key may return a temporary, it is called again in every pass instead of keeping references
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename get_key_t, typename resolve_t>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_pairs_of_batch(const size_t batch_count, get_key_t&& get_key, resolve_t&& resolve) const
+{
+	KB_CORE_ASSERT(batch_count <= s_lookup_batch_size, "batch is larger than the lookup batch size!");
 
-	// normal hash map indexing using the h1 hash
-	size_t index = h1_hash % m_max_elements;
+	hash_t hashes[s_lookup_batch_size];
+	for (size_t i = 0; i < batch_count; ++i)
+	{
+		hashes[i] = hash_key(get_key(i));
+		const probe_sequence_t probe{ metadata_t::get_h1_hash(hashes[i]), get_capacity_mask() };
+		details::prefetch(m_metadata_bucket + probe.get_offset());
+	}
+
+	for (size_t i = 0; i < batch_count; ++i)
+	{
+		const probe_sequence_t probe{ metadata_t::get_h1_hash(hashes[i]), get_capacity_mask() };
+		const group_t group{ m_metadata_bucket + probe.get_offset() };
+		if (const mask_t candidates = group.match(metadata_t::get_h2_hash(hashes[i])))
+			details::prefetch(m_bucket + probe.get_offset(candidates.lowest_index()));
+	}
+
+	for (size_t i = 0; i < batch_count; ++i)
+	{
+		const hash_t h1_hash = metadata_t::get_h1_hash(hashes[i]);
+		const h2_t h2_hash = metadata_t::get_h2_hash(hashes[i]);
+		const size_t index = find_index_of(h1_hash, h2_hash, get_key(i));
+		if (is_slot_occupied(m_metadata_bucket[index]))
+			resolve(i, m_bucket + index);
+		else
+			resolve(i, find_pair_in_rebuild_source(h1_hash, h2_hash, get_key(i)));
+	}
+}
+
+// insert a range in batches, the home groups of a whole batch are prefetched before the first key is probed
+// prefetches of a batch go stale when an insertion grows the bucket, which only costs the misses they were meant to hide
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename iterator_t, typename get_key_t, typename construct_t>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::insert_many(iterator_t first, iterator_t last, get_key_t&& get_key, construct_t&& construct)
+{
+	static_assert(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>, "insert_many requires forward iterators");
+
+	iterator_t batch[s_lookup_batch_size];
+	hash_t hashes[s_lookup_batch_size];
+	while (first != last)
+	{
+		size_t batch_count = 0;
+		for (; first != last && batch_count < s_lookup_batch_size; ++first, ++batch_count)
+		{
+			batch[batch_count] = first;
+			hashes[batch_count] = hash_key(get_key(*first));
+			const probe_sequence_t probe{ metadata_t::get_h1_hash(hashes[batch_count]), get_capacity_mask() };
+			details::prefetch(m_metadata_bucket + probe.get_offset());
+		}
+
+		for (size_t i = 0; i < batch_count; ++i)
+		{
+			const insert_slot_t slot = find_or_prepare_insert(get_key(*batch[i]), hashes[i]);
+			if (slot.found)
+				continue;
+
+			construct(slot.index, slot.hash_value, *batch[i]);
+			++m_element_count;
+		}
+	}
+}
+
+// find a batch of keys, missing keys are written as nullptr
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_many(const key_t* keys, const size_t count, value_t** out)
+{
+	find_pairs_of_many(keys, count, [out](const size_t position, hash_map_pair_t* pair)
+		{
+			out[position] = pair ? &pair->value : nullptr;
+		}
+	);
+}
+
+// find a batch of keys, missing keys are written as nullptr
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_many(const key_t* keys, const size_t count, const value_t** out) const
+{
+	find_pairs_of_many(keys, count, [out](const size_t position, hash_map_pair_t* pair)
+		{
+			out[position] = pair ? &pair->value : nullptr;
+		}
+	);
+}
+
+// check whether each key in a batch is in the map
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::contains_many(const key_t* keys, const size_t count, bool* out) const
+{
+	find_pairs_of_many(keys, count, [out](const size_t position, const hash_map_pair_t* pair)
+		{
+			out[position] = pair != nullptr;
+		}
+	);
+}
+
+// find the first empty or deleted slot in the probe sequence of a hash
+// used when the key is known to not be in the map (e.g. when rebuilding), so no key comparisons are needed
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline size_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_insert_index_of(const hash_t h1_hash) const
+{
+	probe_sequence_t probe{ h1_hash, get_capacity_mask() };
 
-	// #TODO this is subject to infinite looping if the map is completely full, though we should never get to that point...
 	while (true)
 	{
-		const metadata_t* metadata_ptr;
-		
-		// the normal case is when the index <= max_elements - 16
-		// this means we can just pass a pointer to the metadata bucket
-		if (index <= m_max_elements - s_metadata_count_to_check) // #TODO see if msvc has likely branch attribute
+		const group_t group{ m_metadata_bucket + probe.get_offset() };
+		if (const mask_t free_slots = group.match_empty_or_deleted())
+			return probe.get_offset(free_slots.lowest_index());
+
+		probe.next();
+	}
+}
+
+// count the groups probed to resolve a key, including the group where probing stops (so the minimum is 1)
+// walks the same sequence as find_index_of
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+size_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::get_probe_length(const key_t& key) const
+{
+	const hash_t hash_value = hash_key(key);
+	const h2_t h2_hash = metadata_t::get_h2_hash(hash_value);
+	probe_sequence_t probe{ metadata_t::get_h1_hash(hash_value), get_capacity_mask() };
+
+	while (true)
+	{
+		const group_t group{ m_metadata_bucket + probe.get_offset() };
+
+		for (const size_t i : group.match(h2_hash))
+			if (m_key_equal(get_slot_key(m_bucket[probe.get_offset(i)]), key))
+				return probe.get_probe_length() + 1;
+
+		if (group.match_empty())
+			return probe.get_probe_length() + 1;
+
+		probe.next();
+	}
+}
+
+// occupancy is read from the map, the counters are only filled in when they are compiled in
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+details::hash_map_stats flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::stats() const
+{
+	details::hash_map_stats result{};
+	KB_FLAT_HASH_MAP_STATS_ONLY(m_stats.fill(result);)
+	result.element_count = m_element_count;
+	result.deleted_count = m_deleted_count;
+	result.max_elements = max_size();
+	result.allocated_bytes = get_allocated_bytes();
+	return result;
+}
+
+// visit every occupied slot, one metadata group at a time
+// entries in the old bucket of a running incremental rebuild are visited after the bucket
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename function_t>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::for_each(function_t&& function)
+{
+	visit_occupied_slots(m_metadata_bucket, m_max_elements, [this, &function](const size_t index) { function(m_bucket[index]); });
+
+	const rebuild_source_t& source = m_rebuild_source;
+	if (source.bucket)
+		visit_occupied_slots(source.metadata_bucket, source.max_elements, [&source, &function](const size_t index) { function(source.bucket[index]); });
+}
+
+// visit every occupied slot, one metadata group at a time
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename function_t>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::for_each(function_t&& function) const
+{
+	visit_occupied_slots(m_metadata_bucket, m_max_elements, [this, &function](const size_t index) 
+		{ 
+			function(static_cast<const hash_map_pair_t&>(m_bucket[index])); 
+		}
+	);
+
+	const rebuild_source_t& source = m_rebuild_source;
+	if (source.bucket)
+		visit_occupied_slots(source.metadata_bucket, source.max_elements, [&source, &function](const size_t index) 
+			{ 
+				function(static_cast<const hash_map_pair_t&>(source.bucket[index])); 
+			}
+		);
+}
+
+// scan whole metadata groups, and visit the slots of each group's full mask
+// groups are aligned and the bucket is a multiple of the group width, so no group reads past the bucket
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename visit_t>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::visit_occupied_slots(const metadata_t* metadata_bucket, const size_t max_elements, visit_t&& visit)
+{
+	for (size_t group_index = 0; group_index < max_elements; group_index += s_metadata_count_to_check)
+		for (const size_t i : group_t{ metadata_bucket + group_index }.match_full())
+			visit(group_index + i);
+}
+
+// find the next occupied pair, continuing in the old bucket of a running incremental rebuild after the end of the bucket
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline typename flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::hash_map_pair_t* flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_occupied_pair_from(const hash_map_pair_t* pair_ptr) const
+{
+	if (pair_ptr >= m_bucket && pair_ptr <= m_bucket + m_max_elements)
+	{
+		const size_t index = find_next_occupied_index(m_metadata_bucket, m_max_elements, static_cast<size_t>(pair_ptr - m_bucket));
+		if (index < m_max_elements)
+			return m_bucket + index;
+
+		if (!m_rebuild_source.bucket)
+			return nullptr;
+
+		pair_ptr = m_rebuild_source.bucket;
+	}
+
+	const rebuild_source_t& source = m_rebuild_source;
+	const size_t index = find_next_occupied_index(source.metadata_bucket, source.max_elements, static_cast<size_t>(pair_ptr - source.bucket));
+	return index < source.max_elements ? source.bucket + index : nullptr;
+}
+
+// find the next occupied slot by loading whole metadata groups, and skipping to the lowest full slot of the mask
+// empty groups are skipped with a single load and compare
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline size_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::find_next_occupied_index(const metadata_t* metadata_bucket, const size_t max_elements, const size_t index)
+{
+	if (index >= max_elements)
+		return max_elements;
+
+	// start at the aligned group containing the index, ignoring slots before the index
+	size_t group_index = index & ~(s_metadata_count_to_check - 1);
+	mask_t full_mask = group_t{ metadata_bucket + group_index }.match_full().without_slots_before(index - group_index);
+
+	while (!full_mask)
+	{
+		group_index += s_metadata_count_to_check;
+		if (group_index >= max_elements)
+			return max_elements;
+
+		full_mask = group_t{ metadata_bucket + group_index }.match_full();
+	}
+
+	return group_index + full_mask.lowest_index();
+}
+
+// round a requested element count up to a power of two, so indices can be wrapped with a mask
+// the bucket is never smaller than a single group
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline size_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::normalize_max_elements(const size_t requested_max_elements)
+{
+	size_t max_elements = s_metadata_count_to_check;
+	while (max_elements < requested_max_elements)
+		max_elements <<= 1;
+
+	return max_elements;
+}
+
+// build the map from a random access range of pairs with several threads, every pair is copied
+// any previous contents are destroyed
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename iterator_t>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::build_parallel(iterator_t first, iterator_t last, size_t thread_count)
+{
+	static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>, 
+		"build_parallel requires random access iterators");
+	static_assert(std::is_convertible_v<decltype(*first), const hash_map_pair_t&>, "build_parallel requires a range of hash map pairs");
+
+	if (thread_count == 0)
+		thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+	// size the bucket once, so the whole range fits below the load factor and nothing rebuilds while placing
+	const size_t count = static_cast<size_t>(std::distance(first, last));
+	size_t new_max_elements = normalize_max_elements(static_cast<size_t>(static_cast<float>(count) / m_load_factor) + 1);
+	while (static_cast<size_t>(static_cast<float>(new_max_elements) * m_load_factor) <= count + 1)
+		new_max_elements <<= 1;
+
+	destroy();
+	allocate_buckets(new_max_elements);
+
+	place_parallel(count, thread_count,
+		[this, first](const size_t i) { return hash_key(static_cast<const hash_map_pair_t&>(first[i]).key); },
+		[first](const size_t i) -> const key_t& { return static_cast<const hash_map_pair_t&>(first[i]).key; },
+		[this, first](const size_t index, const hash_t hash_value, const size_t i) 
+		{ 
+			construct_pair_at(index, hash_value, static_cast<const hash_map_pair_t&>(first[i])); 
+		}
+	);
+}
+
+// entries are placed in three parallel passes, followed by one sequential pass
+// 1. every thread hashes a contiguous chunk of entries, and counts how many land in each region of the bucket
+//    regions are contiguous ranges of groups, one per thread, and an entry lands in the region of its home group (the first group it probes)
+// 2. every thread scatters the indices of its chunk, so the entries of each region are contiguous and keep their order
+// 3. every thread fills one region, only ever placing an entry in its home group, so threads never touch the same metadata
+// 4. entries whose home group was full are inserted normally, probing as far as needed
+// an entry is either found in its home group or inserted with the regular probe sequence, so lookups need no special handling
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename get_hash_t, typename get_key_t, typename construct_t>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::place_parallel(
+	const size_t count, 
+	size_t thread_count, 
+	get_hash_t&& get_hash, 
+	get_key_t&& get_key, 
+	construct_t&& construct
+)
+{
+	KB_CORE_ASSERT(m_element_count == 0 && m_deleted_count == 0, "entries can only be placed into an empty bucket");
+	KB_CORE_ASSERT(count < get_max_load(), "bucket is too small for the entries");
+
+	const size_t group_count = m_max_elements / s_metadata_count_to_check;
+	thread_count = std::min({ thread_count, group_count, count / s_parallel_min_entries_per_thread });
+
+	// not worth starting threads, insert every entry normally
+	if (thread_count <= 1)
+	{
+		for (size_t i = 0; i < count; ++i)
 		{
-			metadata_ptr = m_metadata_bucket + index;
+			const insert_slot_t slot = find_or_prepare_insert(get_key(i), get_hash(i));
+			if (slot.found)
+				continue;
+
+			construct(slot.index, slot.hash_value, i);
+			++m_element_count;
 		}
-		else
+
+		return;
+	}
+
+	const size_t groups_per_region = (group_count + thread_count - 1) / thread_count;
+	const auto get_home_offset = [this](const hash_t hash_value) 
+	{ 
+		return metadata_t::get_h1_hash(hash_value) & get_capacity_mask() & ~(s_metadata_count_to_check - 1); 
+	};
+	const auto get_region = [&](const hash_t hash_value) { return get_home_offset(hash_value) / s_metadata_count_to_check / groups_per_region; };
+	const auto get_chunk_begin = [count, thread_count](const size_t chunk) { return count / thread_count * chunk + std::min(chunk, count % thread_count); };
+
+	// 1. hash every entry and count the entries of each (chunk, region) pair
+	std::vector<hash_t> hashes(count);
+	std::vector<size_t> region_cursors(thread_count * thread_count);
+	details::parallel_for(thread_count, [&](const size_t chunk)
 		{
-			// since sse2 needs the memory to be 16 bytes, we use a cached, contiguous array
-			// copy metadata into bucket cache
-			for (size_t i = 0; i < s_metadata_count_to_check; ++i)
+			std::vector<size_t> region_counts(thread_count);
+			for (size_t i = get_chunk_begin(chunk); i < get_chunk_begin(chunk + 1); ++i)
 			{
-				const size_t metadata_index = (index + i) % m_max_elements;
-				// copy data to temporary bucket
-				// since it's only 16 bytes, copies *should* be fine
-				m_temporary_metadata_bucket[i] = m_metadata_bucket[metadata_index];
+				hashes[i] = get_hash(i);
+				++region_counts[get_region(hashes[i])];
 			}
 
-			metadata_ptr = m_temporary_metadata_bucket;
+			std::copy(region_counts.begin(), region_counts.end(), region_cursors.begin() + chunk * thread_count);
 		}
+	);
 
-		// use sse2 instructions to search for 16 potential candidates at once
-		const mask_t candidates = find_matches_sse2(h2_hash, metadata_ptr);
+	// turn the counts into the position each (chunk, region) pair starts writing at, regions first so chunks stay in order
+	std::vector<size_t> region_begins(thread_count + 1);
+	size_t position = 0;
+	for (size_t region = 0; region < thread_count; ++region)
+	{
+		region_begins[region] = position;
+		for (size_t chunk = 0; chunk < thread_count; ++chunk)
+		{
+			const size_t region_count = region_cursors[chunk * thread_count + region];
+			region_cursors[chunk * thread_count + region] = position;
+			position += region_count;
+		}
+	}
+	region_begins[thread_count] = position;
 
-		// equality check on all candidates
-		// #TODO this could probably be optimized
-		for (size_t i = 0ull; i < s_metadata_count_to_check; ++i)
+	// 2. sort entry indices by region
+	std::vector<size_t> order(count);
+	details::parallel_for(thread_count, [&](const size_t chunk)
 		{
-			if (is_slot_empty(metadata_ptr[i]))
-				return (index + i) % m_max_elements;
-			
-			const bool candidate = candidates & (0b1 << i);
-			if (!candidate)
-				continue;
+			size_t* cursors = region_cursors.data() + chunk * thread_count;
+			for (size_t i = get_chunk_begin(chunk); i < get_chunk_begin(chunk + 1); ++i)
+				order[cursors[get_region(hashes[i])]++] = i;
+		}
+	);
 
-			// since we check 16 elements at once, another modulus is required 
-			// so we don't accidentally overflow the pair bucket
-			const size_t bucket_index = (index + i) % m_max_elements;
-			// check whether the key matches and the slot is occupied
-			const bool is_occupied_and_key_matches = is_slot_occupied(metadata_ptr[i]) && m_bucket[bucket_index].key == key;
-			if (is_occupied_and_key_matches)
-				return (index + i) % m_max_elements;
+	// 3. fill each region's home groups, deferring entries whose home group is full
+	// once a home group is full it stays full, so every later copy of a deferred key is deferred as well
+	std::vector<size_t> placed_counts(thread_count);
+	std::vector<std::vector<size_t>> deferred_entries(thread_count);
+	details::parallel_for(thread_count, [&](const size_t region)
+		{
+			size_t placed_count = 0;
+			for (size_t position = region_begins[region]; position < region_begins[region + 1]; ++position)
+			{
+				const size_t i = order[position];
+				const hash_t hash_value = hashes[i];
+				const size_t offset = get_home_offset(hash_value);
+				const group_t group{ m_metadata_bucket + offset };
+
+				bool is_duplicate = false;
+				for (const size_t slot : group.match(metadata_t::get_h2_hash(hash_value)))
+				{
+					if (m_key_equal(get_slot_key(m_bucket[offset + slot]), get_key(i)))
+					{
+						is_duplicate = true;
+						break;
+					}
+				}
+
+				if (is_duplicate)
+					continue;
+
+				if (const mask_t empty_slots = group.match_empty())
+				{
+					construct(offset + empty_slots.lowest_index(), hash_value, i);
+					++placed_count;
+				}
+				else
+					deferred_entries[region].push_back(i);
+			}
+
+			placed_counts[region] = placed_count;
 		}
+	);
 
-		// otherwise continue probing
-		index = (index + s_metadata_count_to_check) % m_max_elements;
+	for (const size_t placed_count : placed_counts)
+		m_element_count += placed_count;
+
+	// 4. insert deferred entries, copies of one key always share a region so the first copy still wins
+	for (const std::vector<size_t>& region_deferred_entries : deferred_entries)
+	{
+		for (const size_t i : region_deferred_entries)
+		{
+			const insert_slot_t slot = find_or_prepare_insert(get_key(i), hashes[i]);
+			if (slot.found)
+				continue;
+
+			construct(slot.index, slot.hash_value, i);
+			++m_element_count;
+		}
 	}
-#if 0
-	const hash_t hash_value = hash::generate_u64_fnv1a_hash(key);
-	size_t index = hash_value % m_max_elements;
-	// this can be subject to infinite loop if load balance == 1, though we should never get to that point...
-	while (is_slot_occupied(m_bucket[index]) && m_bucket[index].key != key)
-		index = (index + 1) % m_max_elements;
+}
 
-	return index;
-#endif
+// gather occupied slot indices, every thread scans a contiguous range of groups
+// the ranges are concatenated in order, so indices stay ascending
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline std::vector<size_t> flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::get_occupied_indices(const metadata_t* metadata_bucket, const size_t max_elements, size_t thread_count) const
+{
+	const size_t group_count = max_elements / s_metadata_count_to_check;
+	thread_count = std::max<size_t>(std::min(thread_count, group_count * s_metadata_count_to_check / s_parallel_min_entries_per_thread), 1);
+	const size_t groups_per_range = (group_count + thread_count - 1) / thread_count;
+
+	std::vector<std::vector<size_t>> range_indices(thread_count);
+	details::parallel_for(thread_count, [&](const size_t range)
+		{
+			const size_t begin = std::min(range * groups_per_range, group_count) * s_metadata_count_to_check;
+			const size_t end = std::min((range + 1) * groups_per_range, group_count) * s_metadata_count_to_check;
+			visit_occupied_slots(metadata_bucket + begin, end - begin, [&](const size_t index) { range_indices[range].push_back(begin + index); });
+		}
+	);
+
+	if (thread_count == 1)
+		return std::move(range_indices[0]);
+
+	std::vector<size_t> occupied_indices;
+	size_t occupied_count = 0;
+	for (const std::vector<size_t>& indices : range_indices)
+		occupied_count += indices.size();
+
+	occupied_indices.reserve(occupied_count);
+	for (const std::vector<size_t>& indices : range_indices)
+		occupied_indices.insert(occupied_indices.end(), indices.begin(), indices.end());
+
+	return occupied_indices;
 }
 
 // rebuild the map, doubling its max element count
 // moves old map entries to the new bucket
-template <typename K, typename V>
-inline void flat_unordered_hash_map<K, V>::rebuild()
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::rebuild()
+{
+	rebuild(m_max_elements * 2);
+}
+
+// rebuild the map with a specific max element count, which must be a power of two and fit every entry
+// moves old map entries to the new bucket
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::rebuild(const size_t new_max_elements)
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
+	KB_CORE_ASSERT((new_max_elements & (new_max_elements - 1)) == 0, "max elements must be a power of two!");
+
+	// explicit rebuilds (reserve, merge) are not incremental
+	finish_incremental_rebuild();
+	KB_FLAT_HASH_MAP_STATS_ONLY(const details::rebuild_timer timer{ m_stats };)
 
 	hash_map_pair_t* old_bucket = m_bucket;
 	metadata_t* old_metadata_bucket = m_metadata_bucket;
-	const size_t old_element_count = m_max_elements;
+	const hash_t* old_hash_bucket = m_hash_bucket;
+	const size_t old_max_elements = m_max_elements;
+
+	allocate_buckets(new_max_elements);
+	m_deleted_count = 0;
+
+	// large maps are moved with several threads, keys are unique so every entry is placed
+	if (m_rebuild_thread_count != 1 && m_element_count >= m_parallel_rebuild_min_elements)
+	{
+		const size_t thread_count = m_rebuild_thread_count ? m_rebuild_thread_count : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		const std::vector<size_t> occupied_indices = get_occupied_indices(old_metadata_bucket, old_max_elements, thread_count);
+
+		m_element_count = 0;
+		place_parallel(occupied_indices.size(), thread_count,
+			[&](const size_t i) { return get_slot_hash(old_bucket, old_hash_bucket, occupied_indices[i]); },
+			[&](const size_t i) -> const key_t& { return get_slot_key(old_bucket[occupied_indices[i]]); },
+			[&](const size_t index, const hash_t hash_value, const size_t i)
+			{
+				construct_pair_at(index, hash_value, std::move(old_bucket[occupied_indices[i]]));
+				old_bucket[occupied_indices[i]].~hash_map_pair_t();
+			}
+		);
+		KB_CORE_ASSERT(m_element_count == occupied_indices.size(), "parallel rebuild lost entries!");
 
-	// double size of new bucket
-	m_max_elements *= 2;
-	m_bucket = new hash_map_pair_t[m_max_elements]{};
-	m_metadata_bucket = new metadata_t[m_max_elements]{};
+		deallocate_buckets(old_metadata_bucket, old_max_elements);
+		return;
+	}
 
 	// move old elements to new map
-	for (size_t i = 0; i < old_element_count; ++i)
+	for (size_t i = 0; i < old_max_elements; ++i)
 	{
 		if (!is_slot_occupied(old_metadata_bucket[i]))
 			continue;
 
-		// compute general hash, and mask out h1 and h2 hashes
-		const key_t& key = old_bucket[i].key;
-		const hash_t hash_value = hash::generate_u64_fnv1a_hash(key);
-		const hash_t h1_hash = hash_value & metadata_t::h1_hash_mask;
-		const h2_t h2_hash = static_cast<h2_t>((hash_value & metadata_t::h2_hash_mask) >> 0x39);
-		const size_t index = find_index_of(h1_hash, h2_hash, key);
-
-		hash_map_pair_t* slot_ptr = m_bucket + index;
-		// move construct in bucket memory
-		//new (slot_ptr) hash_map_pair_t{ std::move(old_bucket[i]) };
-		m_bucket[index] = std::move(old_bucket[i]);
-		m_metadata_bucket[index] = metadata_t{ static_cast<uint8_t>(metadata_t::occupied_bit_flag | h2_hash) };
+		// get the general hash (stored or recomputed), and mask out the h1 hash
+		// keys are unique, so the first free slot in the probe sequence can be used directly
+		const hash_t hash_value = get_slot_hash(old_bucket, old_hash_bucket, i);
+		const size_t index = find_insert_index_of(metadata_t::get_h1_hash(hash_value));
+
+		// move construct in the new bucket, and destroy the moved from pair
+		construct_pair_at(index, hash_value, std::move(old_bucket[i]));
+		old_bucket[i].~hash_map_pair_t();
 	}
 		
-	if (old_bucket)
-		delete[] old_bucket;
-
-	if (old_metadata_bucket)
-		delete[] old_metadata_bucket;
+	deallocate_buckets(old_metadata_bucket, old_max_elements);
 }
 
 // try inserting a value if the key does not exist in the map, otherwise assign the value at the key
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::insert_or_assign()
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::insert_or_assign()
 {
 	KB_CORE_ASSERT(false, "not implemented!");
 }
 
 // emplace a value in the map, does not care whether the key already exists or not
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::emplace(hash_map_pair_t&& pair)
+// the value of an existing pair with the same key is replaced
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::emplace(hash_map_pair_t&& pair)
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
+	const insert_slot_t slot = find_or_prepare_insert(pair.key);
 
-	// rebuild the map if we are getting too full
-	check_if_needs_rebuild();
-
-	// compute general hash, and mask out h1 and h2 hashes
-	const hash_t hash_value = hash::generate_u64_fnv1a_hash(pair.key);
-	const hash_t h1_hash = hash_value & metadata_t::h1_hash_mask;
-	const h2_t h2_hash = static_cast<h2_t>((hash_value & metadata_t::h2_hash_mask) >> 0x39);
-	const size_t index = find_index_of(h1_hash, h2_hash, pair.key);
+	// an existing entry keeps its key and has its value assigned, if the assignment throws the pair is still intact
+	if (slot.found)
+	{
+		m_bucket[slot.index].value = std::move(pair.value);
+		return;
+	}
 
-	// pointer to where the pair will be move constructed
-	hash_map_pair_t* pair_ptr = m_bucket + index;
-	// move construct in bucket memory
-	//new (pair_ptr) hash_map_pair_t{ std::move(pair) };
-	*pair_ptr = std::move(pair);
-	// set metadata
-	m_metadata_bucket[index] = metadata_t{ static_cast<uint8_t>(metadata_t::occupied_bit_flag | h2_hash) };
+	// move construct in bucket memory, only counted once construction succeeded
+	construct_pair_at(slot.index, slot.hash_value, std::move(pair));
 	++m_element_count;
-#if 0
-	check_if_needs_rebuild();
-
-	pair.flags |= details::hash_map_pair<K, V>::occupied_bit_flag;
-	hash_map_pair_t* found_pair_ptr = m_bucket + find_index_of(pair.key);
-	new (found_pair_ptr) hash_map_pair_t{ std::move(pair) };
-	m_element_count++;
-#endif
 }
 
 // emplace a value in the map, does not care whether the key already exists or not
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::emplace(K&& key, V&& value)
+// the value of an existing pair with the same key is replaced
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::emplace(K&& key, V&& value)
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
-
-	// rebuild the map if we are getting too full
-	check_if_needs_rebuild();
+	const insert_slot_t slot = find_or_prepare_insert(key);
 
-	// compute general hash, and mask out h1 and h2 hashes
-	const hash_t hash_value = hash::generate_u64_fnv1a_hash(key);
-	const hash_t h1_hash = hash_value & metadata_t::h1_hash_mask;
-	const h2_t h2_hash = static_cast<h2_t>((hash_value & metadata_t::h2_hash_mask) >> 0x39);
-	const size_t index = find_index_of(h1_hash, h2_hash, key);
+	// an existing entry keeps its key and has its value assigned, if the assignment throws the pair is still intact
+	if (slot.found)
+	{
+		m_bucket[slot.index].value = std::move(value);
+		return;
+	}
 
-	// pointer to where the pair will be move constructed
-	hash_map_pair_t* pair_ptr = m_bucket + index;
-	// move construct in bucket memory
-	//new (pair_ptr) hash_map_pair_t{ std::move(key), std::move(value) };
-	pair_ptr->key = std::move(key);
-	pair_ptr->value = std::move(value);
-	// set metadata
-	m_metadata_bucket[index] = metadata_t{ static_cast<uint8_t>(metadata_t::occupied_bit_flag | h2_hash) };
+	// move construct in bucket memory, only counted once construction succeeded
+	construct_pair_at(slot.index, slot.hash_value, std::move(key), std::move(value));
 	++m_element_count;
-
-#if 0
-	check_if_needs_rebuild();
-
-	hash_map_pair_t* found_pair_ptr = m_bucket + find_index_of(key);
-	new (found_pair_ptr) hash_map_pair_t{ std::move(key), std::move(value), details::hash_map_pair<K, V>::occupied_bit_flag };
-	m_element_count++;
-#endif
 }
 
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::emplace_hint()
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::emplace_hint()
 {
 	KB_CORE_ASSERT(false, "not implemented!");
 }
 
 // try emplace a value in the map if the key does not exist, otherwise do nothing
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::try_emplace(hash_map_pair_t&& pair)
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::try_emplace(hash_map_pair_t&& pair)
 {
-	KB_CORE_ASSERT(false, "invalid implementation!");
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
-
-	hash_map_pair_t& found_pair = m_bucket[find_index_of(pair.key)];
-	if (is_slot_occupied(found_pair))
-	{
+	const insert_slot_t slot = find_or_prepare_insert(pair.key);
+	if (slot.found)
 		return;
-	}
 
-	// is this correct? should we instead get a pointer to the pair and move with de-referencing?
-	found_pair = std::move(pair);
+	// move construct in bucket memory
+	construct_pair_at(slot.index, slot.hash_value, std::move(pair));
+	++m_element_count;
 }
 
 // erase an entry from the map via key
-// uses tombstone deletion, where the metadata flag for "delete" is set
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::erase(const key_t& key)
+// destroys the pair, and marks the slot as empty when possible, otherwise uses tombstone deletion
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t, typename>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::erase(const key_arg_t& key)
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
-
 	// make sure we don't try to delete from an empty map
 	if (m_element_count == 0)
 		return;
 
-	const size_t index = find_index_of(key);
+	const hash_t hash_value = hash_key(key);
+	continue_incremental_rebuild(key, hash_value);
+
+	const size_t index = find_index_of(metadata_t::get_h1_hash(hash_value), metadata_t::get_h2_hash(hash_value), key);
 	if (!is_slot_occupied(m_metadata_bucket[index]))
 	{
 #ifdef KB_DEBUG
@@ -1081,183 +2890,445 @@ void flat_unordered_hash_map<K, V>::erase(const key_t& key)
 		return;
 	}
 
-	// tombstone deletion
-	m_metadata_bucket[index] |= metadata_t::deleted_bit_flag;
-	--m_element_count;
-	// std::memset(m_bucket + index, 0, sizeof(hash_map_pair_t));
+	// destroy the pair so its resources are released right away
+	erase_at(index);
 }
 
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::swap(flat_unordered_hash_map& other)
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::swap(flat_unordered_hash_map& other)
 {
-	// swap bucket pointers
-	std::swap(m_bucket, other.m_bucket);
-	// swap element count
-	std::swap(m_element_count, other.m_element_count);
-	// swap max load
-	std::swap(m_max_elements, other.m_max_elements);
+	// inline blocks cannot change owners, so their entries are moved through a temporary map
+	if (uses_inline_block() || other.uses_inline_block())
+	{
+		flat_unordered_hash_map temporary{ m_hasher, m_key_equal, m_allocator };
+		temporary.take_bucket(other);
+		other.take_bucket(*this);
+		take_bucket(temporary);
+	}
+	else
+	{
+		// swap bucket pointers
+		std::swap(m_bucket, other.m_bucket);
+		// swap element count
+		std::swap(m_element_count, other.m_element_count);
+		// swap deleted count
+		std::swap(m_deleted_count, other.m_deleted_count);
+		// swap max load
+		std::swap(m_max_elements, other.m_max_elements);
+		// swap metadata
+		std::swap(m_metadata_bucket, other.m_metadata_bucket);
+		// swap stored hashes
+		std::swap(m_hash_bucket, other.m_hash_bucket);
+		// swap incremental rebuild state
+		std::swap(m_rebuild_source, other.m_rebuild_source);
+	}
 	// swap load factor
 	std::swap(m_load_factor, other.m_load_factor);
-	// swap metadata
-	std::swap(m_metadata_bucket, other.m_metadata_bucket);
-	// swap contiguous metadata cache
-	std::swap(m_temporary_metadata_bucket, other.m_temporary_metadata_bucket);
+	// swap incremental rebuild settings
+	std::swap(m_incremental_rebuild_group_count, other.m_incremental_rebuild_group_count);
+	// swap parallel rebuild settings
+	std::swap(m_rebuild_thread_count, other.m_rebuild_thread_count);
+	std::swap(m_parallel_rebuild_min_elements, other.m_parallel_rebuild_min_elements);
+	// swap allocators, allocators that do not propagate (e.g. std::pmr) must be equal
+	if constexpr (block_allocator_traits_t::propagate_on_container_swap::value)
+		std::swap(m_allocator, other.m_allocator);
+	else
+		KB_CORE_ASSERT(m_allocator == other.m_allocator, "cannot swap maps with unequal allocators!");
+	// swap hash and key equality functions
+	std::swap(m_hasher, other.m_hasher);
+	std::swap(m_key_equal, other.m_key_equal);
 }
 
 // extract a pair from the map
 // allocates new memory for the pair and returns an owning pointer
-// zeros out the original entry in the map
-template <typename K, typename V>
-details::hash_map_pair<K, V>* flat_unordered_hash_map<K, V>::extract(const K& key)
+// destroys the original entry in the map
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+details::hash_map_pair<K, V>* flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::extract(const K& key)
 {
-	KB_CORE_ASSERT(false, "invalid implementation!");
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
+	const hash_t hash_value = hash_key(key);
+	continue_incremental_rebuild(key, hash_value);
 
-	const size_t index = find_index_of(key);
-	KB_CORE_ASSERT(is_slot_occupied(m_bucket[index]), "tried extracting a pair that does not exist in the map!");
+	const size_t index = find_index_of(metadata_t::get_h1_hash(hash_value), metadata_t::get_h2_hash(hash_value), key);
+	if (!is_slot_occupied(m_metadata_bucket[index]))
+	{
+		KB_CORE_ASSERT(false, "tried extracting a pair that does not exist in the map!");
+		return nullptr;
+	}
 	
-	// copy pair to new memory address
-	hash_map_pair_t* new_pair = new hash_map_pair_t;
-	*new_pair = m_bucket[index];
+	// move pair to new memory address
+	hash_map_pair_t* new_pair = new hash_map_pair_t(std::move(m_bucket[index]));
 
-	// zero out existing pair in map
-	m_bucket[index] = hash_map_pair_t{};
-	// std::memset(m_bucket[index], 0, sizeof(hash_map_pair_t));
+	// destroy existing pair in map
+	erase_at(index);
 
 	return new_pair;
 }
 
 // merge (mutation) two maps together
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::merge(const flat_unordered_hash_map& other)
+// keys already present in this map are kept
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::merge(const flat_unordered_hash_map& other)
 {
-	KB_CORE_ASSERT(false, "invalid implementation!");
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
-
 	// #TODO should we just reserve a size big enough in one pass?
-	while (size() + other.size() >= static_cast<size_t>(static_cast<float>(m_max_elements) * m_load_factor))
+	while (size() + m_deleted_count + other.size() >= get_max_load())
 		rebuild();
 
-	// iterate through other map and insert values
-	for (size_t i = 0; i < other.m_max_elements; ++i)
-		if (is_slot_occupied(other.m_bucket[i]))
-			insert(other.m_bucket[i]);
+	// insert values of the other map that are not in this map yet
+	// stored hashes of the other map are only reused when the hasher has no state, so both maps hash keys the same way
+	const auto merge_slot = [this, &other](const hash_map_pair_t* bucket, const hash_t* hash_bucket, const size_t index)
+	{
+		const hash_t hash_value = std::is_empty_v<hasher_t> 
+			? other.get_slot_hash(bucket, hash_bucket, index) 
+			: hash_key(get_slot_key(bucket[index]));
+		const insert_slot_t slot = find_or_prepare_insert(get_slot_key(bucket[index]), hash_value);
+		if (slot.found)
+			return;
+
+		construct_pair_at(slot.index, slot.hash_value, bucket[index]);
+		++m_element_count;
+	};
+
+	visit_occupied_slots(other.m_metadata_bucket, other.m_max_elements, [&other, &merge_slot](const size_t index) 
+		{
+			merge_slot(other.m_bucket, other.m_hash_bucket, index); 
+		}
+	);
+
+	// entries the other map has not migrated yet
+	const rebuild_source_t& source = other.m_rebuild_source;
+	if (source.bucket)
+		visit_occupied_slots(source.metadata_bucket, source.max_elements, [&source, &merge_slot](const size_t index) 
+			{
+				merge_slot(source.bucket, source.hash_bucket, index); 
+			}
+		);
 }
 
 // reserve more space in the map
 // throws error if the operation attempts to make the map smaller
-// size is number of elements (not size in bytes)
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::reserve(size_t new_size)
+// size is number of elements (not size in bytes), rounded up to the next power of two
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::reserve(size_t new_size)
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
-
-	KB_CORE_ASSERT(m_max_elements < new_size, "cannot resize map to be smaller!")
-
-	hash_map_pair_t* old_bucket = m_bucket;
-	metadata_t* old_metadata_bucket = m_metadata_bucket;
-	m_bucket = new hash_map_pair_t[new_size];
-	m_metadata_bucket = new metadata_t[new_size];
-
-	// move old bucket to newly allocated space
-	// insert will also update metadata
-	for (size_t i = 0; i < m_max_elements; ++i)
-		if (old_metadata_bucket[i].is_slot_occupied())
-			insert(std::move(old_bucket[i])); 
-
-	m_max_elements = new_size;
+	const size_t new_max_elements = normalize_max_elements(new_size);
+	if (!m_bucket)
+	{
+		allocate_buckets(new_max_elements);
+		return;
+	}
 
-	// free old bucket memory
-	if (old_bucket)
-		delete[] old_bucket;
+	KB_CORE_ASSERT(m_max_elements < new_max_elements, "cannot resize map to be smaller!")
+	if (new_max_elements <= m_max_elements)
+		return;
 
-	// free old metadata memory
-	if (old_metadata_bucket)
-		delete[] old_metadata_bucket;
+	rebuild(new_max_elements);
 }
 
-// resize the map to a specific size
+// resize the map to a specific size, rounded up to the next power of two
 // can make the map smaller, but will not guarantee which keys remain
-template <typename K, typename V>
-void flat_unordered_hash_map<K, V>::resize(size_t new_size)
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::resize(size_t new_size)
 {
-	KB_CORE_ASSERT(m_bucket, "bucket pointer is invalid, did you forget to construct the map?");
 	KB_CORE_ASSERT(new_size > 0, "cannot resize map to size 0, try using clear() instead");
 
+	finish_incremental_rebuild();
+
+	// every entry fits, nothing has to be dropped
+	const size_t new_max_elements = normalize_max_elements(new_size);
+	if (m_element_count < static_cast<size_t>(static_cast<float>(new_max_elements) * m_load_factor) - 1)
+	{
+		rebuild(new_max_elements);
+		return;
+	}
+
 	hash_map_pair_t* old_bucket = m_bucket;
 	metadata_t* old_metadata_bucket = m_metadata_bucket;
-	m_bucket = new hash_map_pair_t[new_size]{};
-	m_metadata_bucket = new metadata_t[new_size]{};
+	const hash_t* old_hash_bucket = m_hash_bucket;
+	const size_t old_max_elements = m_max_elements;
 
-	// insert old elements into new map
-	const size_t min_new_size = std::min(m_max_elements, new_size);
-	for (size_t i = 0; i < min_new_size; ++i)
+	allocate_buckets(new_max_elements);
+	m_deleted_count = 0;
+
+	// insert old elements into new map until the new map reaches its load factor, the rest are dropped
+	const size_t max_kept_elements = static_cast<size_t>(static_cast<float>(m_max_elements) * m_load_factor) - 1;
+	m_element_count = 0;
+	for (size_t i = 0; i < old_max_elements; ++i)
 	{
 		if (!old_metadata_bucket[i].is_slot_occupied())
 			continue;
 		
-		insert(std::move(old_bucket[i]));
+		if (m_element_count < max_kept_elements)
+		{
+			const hash_t hash_value = get_slot_hash(old_bucket, old_hash_bucket, i);
+			const size_t index = find_insert_index_of(metadata_t::get_h1_hash(hash_value));
+
+			construct_pair_at(index, hash_value, std::move(old_bucket[i]));
+			++m_element_count;
+		}
+
+		old_bucket[i].~hash_map_pair_t();
 	}
 
-	if (old_bucket)
-		delete[] old_bucket;
+	deallocate_buckets(old_metadata_bucket, old_max_elements);
+}
+
+// save a snapshot of the map
+// unoccupied slots and padding are written as zeros, so saving the same map always produces the same file
+// string keys are written as ranges of the string arena, which gets the characters of every key in slot order after the pairs
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+bool flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::save(const char* path) const
+{
+	using snapshot_key_t = details::snapshot_key<key_t>;
+	using snapshot_pair_t = details::hash_map_pair<typename snapshot_key_t::stored_key_t, value_t>;
+	constexpr bool has_string_arena = snapshot_key_t::s_storage == details::snapshot_header::s_key_storage_string_arena;
+
+	static_assert(std::is_trivially_copyable_v<typename snapshot_key_t::stored_key_t> && std::is_trivially_copyable_v<value_t>,
+		"only maps with trivially copyable or string keys, and trivially copyable values, can be saved");
+	static_assert(alignof(snapshot_pair_t) <= details::s_cache_line_size, "pairs must fit the cache line alignment of the snapshot");
+	// a running incremental rebuild spreads entries over two buckets, a copy holds all of them in one
+	if (m_rebuild_source.bucket)
+		return flat_unordered_hash_map{ *this }.save(path);
+
+	std::FILE* file = std::fopen(path, "wb");
+	if (!file)
+		return false;
+
+	details::snapshot_header header{};
+	header.magic = details::snapshot_header::s_magic;
+	header.version = details::snapshot_header::s_version;
+	header.group_width = static_cast<uint16_t>(s_metadata_count_to_check);
+	header.pair_alignment = static_cast<uint16_t>(alignof(snapshot_pair_t));
+	header.key_size = static_cast<uint32_t>(sizeof(typename snapshot_key_t::stored_key_t));
+	header.value_size = static_cast<uint32_t>(sizeof(value_t));
+	header.pair_size = static_cast<uint32_t>(sizeof(snapshot_pair_t));
+	header.key_storage = snapshot_key_t::s_storage;
+	header.max_elements = m_max_elements;
+	header.element_count = m_element_count;
+	header.deleted_count = m_deleted_count;
+	header.pair_bucket_offset = get_pair_bucket_offset(m_max_elements);
+	bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+	// metadata including the sentinel, then zeros up to the cache line the pair bucket starts on
+	const size_t metadata_bytes = sizeof(metadata_t) * (m_max_elements + 1);
+	const size_t padding_bytes = get_pair_bucket_offset(m_max_elements) - metadata_bytes;
+	const details::cache_line zero_line{};
+	written = written && std::fwrite(m_metadata_bucket, 1, metadata_bytes, file) == metadata_bytes;
+	written = written && std::fwrite(&zero_line, 1, padding_bytes, file) == padding_bytes;
+
+	// pairs are staged in chunks, so unoccupied slots are written as zeros instead of uninitialized memory
+	std::vector<uint8_t> staging(sizeof(snapshot_pair_t) * std::min(s_snapshot_chunk_size, m_max_elements));
+	uint64_t string_arena_size = 0;
+	for (size_t chunk_begin = 0; written && chunk_begin < m_max_elements; chunk_begin += s_snapshot_chunk_size)
+	{
+		const size_t chunk_size = std::min(s_snapshot_chunk_size, m_max_elements - chunk_begin);
+		std::fill(staging.begin(), staging.end(), uint8_t{ 0 });
+		visit_occupied_slots(m_metadata_bucket + chunk_begin, chunk_size, [this, &staging, &string_arena_size, chunk_begin](const size_t index)
+			{
+				const hash_map_pair_t& pair = m_bucket[chunk_begin + index];
+				if constexpr (has_string_arena)
+				{
+					// value initialized so its padding is zero as well
+					snapshot_pair_t staged_pair{};
+					staged_pair.key = details::snapshot_string_key{ string_arena_size, static_cast<uint64_t>(pair.key.size()) };
+					staged_pair.value = pair.value;
+					string_arena_size += pair.key.size();
+					std::memcpy(staging.data() + sizeof(snapshot_pair_t) * index, static_cast<const void*>(&staged_pair), sizeof(snapshot_pair_t));
+				}
+				else
+					std::memcpy(staging.data() + sizeof(snapshot_pair_t) * index, static_cast<const void*>(&pair), sizeof(snapshot_pair_t));
+			}
+		);
+
+		written = std::fwrite(staging.data(), sizeof(snapshot_pair_t), chunk_size, file) == chunk_size;
+	}
 
-	if (old_metadata_bucket)
-		delete[] old_metadata_bucket;
+	// characters of the keys in the same slot order as their offsets above
+	if constexpr (has_string_arena)
+	{
+		if (written)
+			visit_occupied_slots(m_metadata_bucket, m_max_elements, [this, file, &written](const size_t index)
+				{
+					const key_t& key = m_bucket[index].key;
+					written = written && std::fwrite(key.data(), 1, key.size(), file) == key.size();
+				}
+			);
+	}
+
+	return std::fclose(file) == 0 && written;
 }
 
 // returns a reference to a value via key
-// exception occurs if the key does not exist
-template <typename K, typename V>
-V& flat_unordered_hash_map<K, V>::at(const K& key)
+// asserts if the key does not exist
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t, typename>
+V& flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::at(const key_arg_t& key)
 {
-	const size_t index = find_index_of(key);
-	hash_map_pair_t& found_pair = m_bucket[index];
+	hash_map_pair_t* pair = find_pair(key);
 
-	KB_CORE_ASSERT(is_slot_occupied(found_pair), "key does not exist in the map!");
+	KB_CORE_ASSERT(pair, "key does not exist in the map!");
 
-	return found_pair;
+	return pair->value;
 }
 
 // returns a reference to a value via key
-// exception occurs if the key does not exist
-template <typename K, typename V>
-const V& flat_unordered_hash_map<K, V>::at(const K& key) const
+// asserts if the key does not exist
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t, typename>
+const V& flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::at(const key_arg_t& key) const
 {
-	const size_t index = find_index_of(key);
-	hash_map_pair_t& found_pair = m_bucket[index];
+	hash_map_pair_t* pair = find_pair(key);
 
-	KB_CORE_ASSERT(is_slot_occupied(found_pair), "key does not exist in the map!");
+	KB_CORE_ASSERT(pair, "key does not exist in the map!");
 
-	return found_pair;
+	return pair->value;
 }
 
 // index operator
-template <typename K, typename V>
-V& flat_unordered_hash_map<K, V>::operator[](const K& key)
+// inserts a default constructed value if the key does not exist, the key is only converted to key_t then
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+template <typename key_arg_t, typename>
+V& flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::operator[](const key_arg_t& key)
 {
-	return m_bucket[find_index_of(key)].value;
+	const insert_slot_t slot = find_or_prepare_insert(key);
+	if (slot.found)
+		return m_bucket[slot.index].value;
+
+	// only counted once construction succeeded, converting the key or constructing the value can throw
+	hash_map_pair_t& pair = construct_pair_at(slot.index, slot.hash_value, std::piecewise_construct, key);
+	++m_element_count;
+	return pair.value;
 }
 
 // counting the number of key entries in the map does not make sense since we only use one bucket?
-template <typename K, typename V>
-size_t flat_unordered_hash_map<K, V>::count(const K& key) const
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+size_t flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::count(const K& key) const
 {
 	KB_CORE_ASSERT(false, "not implemented");
 	return 0;
 }
 
-// check whether the map contains a specific key
-template <typename K, typename V>
-bool flat_unordered_hash_map<K, V>::contains(const K& key) const
+// allocate the metadata and pair buckets as one block from the map's allocator
+// the block is laid out as [metadata + sentinel][padding to a cache line][pairs][stored hashes, if enabled]
+// pairs are constructed in-place when inserted
+// a block of the inline size uses the inline block instead, unless the current or old bucket still lives there
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::allocate_buckets(const size_t max_elements)
+{
+	static_assert(alignof(hash_map_pair_t) <= details::s_cache_line_size, "pairs with an alignment larger than a cache line are not supported!");
+
+	details::cache_line* block = nullptr;
+	if constexpr (s_inline_max_elements > 0)
+		if (max_elements == s_inline_max_elements && !uses_inline_block())
+			block = this->get_inline_lines();
+
+	if (!block)
+		block = block_allocator_traits_t::allocate(m_allocator, get_block_line_count(max_elements));
+
+	uint8_t* block_bytes = reinterpret_cast<uint8_t*>(block);
+
+	m_max_elements = max_elements;
+	m_metadata_bucket = reinterpret_cast<metadata_t*>(block_bytes);
+	m_bucket = reinterpret_cast<hash_map_pair_t*>(block_bytes + get_pair_bucket_offset(max_elements));
+	m_hash_bucket = s_store_hash ? reinterpret_cast<hash_t*>(block_bytes + get_hash_bucket_offset(max_elements)) : nullptr;
+
+	// initialize metadata to empty, and mark the end of the bucket
+	// the sentinel is written through the pointer returned by the fill, which also keeps gcc's -Wstringop-overflow quiet at -O3
+	metadata_t* sentinel = std::uninitialized_fill_n(m_metadata_bucket, max_elements, metadata_t{});
+	*sentinel = metadata_t{ metadata_t::sentinel_bit_flag };
+}
+
+// free a block allocated with allocate_buckets
+// the shared empty group and the inline block are not owned by the allocator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::deallocate_buckets(metadata_t* metadata_bucket, const size_t max_elements)
 {
-	return is_slot_occupied(m_bucket[find_index_of(key)]);
+	if (!metadata_bucket || metadata_bucket == details::s_empty_metadata_group.m_data || is_inline_block(metadata_bucket))
+		return;
+
+	block_allocator_traits_t::deallocate(m_allocator, reinterpret_cast<details::cache_line*>(metadata_bucket), get_block_line_count(max_elements));
+}
+
+// take over the bucket of another map, this map must be unallocated
+// the other map's inline block keeps at most a few groups, so its entries are moved into a bucket of the same size
+// which keeps every entry at the same index
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::take_bucket(flat_unordered_hash_map& other)
+{
+	KB_CORE_ASSERT(!m_bucket && !m_rebuild_source.bucket, "map must be unallocated to take over a bucket!");
+
+	if (other.uses_inline_block())
+		other.finish_incremental_rebuild();
+
+	if (!other.is_inline_block(other.m_metadata_bucket))
+	{
+		m_bucket = other.m_bucket;
+		m_metadata_bucket = other.m_metadata_bucket;
+		m_hash_bucket = other.m_hash_bucket;
+		m_element_count = other.m_element_count;
+		m_deleted_count = other.m_deleted_count;
+		m_max_elements = other.m_max_elements;
+		m_rebuild_source = std::exchange(other.m_rebuild_source, rebuild_source_t{});
+		other.reset_to_unallocated();
+		return;
+	}
+
+	allocate_buckets(other.m_max_elements);
+	m_element_count = other.m_element_count;
+	m_deleted_count = other.m_deleted_count;
+	std::copy_n(other.m_metadata_bucket, m_max_elements + 1, m_metadata_bucket);
+	if constexpr (s_store_hash)
+		std::copy_n(other.m_hash_bucket, m_max_elements, m_hash_bucket);
+
+	for (size_t i = 0; i < m_max_elements; ++i)
+	{
+		if (!is_slot_occupied(other.m_metadata_bucket[i]))
+			continue;
+
+		new (m_bucket + i) hash_map_pair_t(std::move(other.m_bucket[i]));
+		other.m_bucket[i].~hash_map_pair_t();
+	}
+
+	other.reset_to_unallocated();
+}
+
+// destroy the pairs of every occupied slot, metadata is left untouched
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash, size_t InlineCapacity>
+inline void flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>::destroy_pairs()
+{
+	if constexpr (!std::is_trivially_destructible_v<hash_map_pair_t>)
+		for (size_t i = 0; i < m_max_elements; ++i)
+			if (is_slot_occupied(m_metadata_bucket[i]))
+				destroy_pair_at(i);
 }
 
 // ==========================
 // end implementation details
 // ==========================
 
+// flat_unordered_hash_map that keeps up to InlineCapacity entries in-object, and only allocates once it grows past them
+// the inline block holds the smallest bucket whose max load fits InlineCapacity entries, usually a single group
+template <
+	typename K, 
+	typename V, 
+	size_t InlineCapacity, 
+	typename Hash = hash::hasher<K>, 
+	typename KeyEqual = hash::key_equal<K>, 
+	typename Allocator = std::allocator<details::hash_map_pair<K, V>>,
+	bool StoreHash = false
+>
+using small_flat_unordered_hash_map = flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>;
+
+namespace pmr
+{ // start namespace ::pmr
+
+	// flat_unordered_hash_map that allocates from a std::pmr::memory_resource, e.g. a monotonic arena
+	template <typename K, typename V, typename Hash = hash::hasher<K>, typename KeyEqual = hash::key_equal<K>, bool StoreHash = false>
+	using flat_unordered_hash_map = container::flat_unordered_hash_map<
+		K, V, Hash, KeyEqual, std::pmr::polymorphic_allocator<details::hash_map_pair<K, V>>, StoreHash
+	>;
+
+} // end namespace ::pmr
+
 } // end namespace Kablunk::util::container
 
 // overloads for structured binding
@@ -0,0 +1,341 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_FLAT_UNORDERED_HASH_SET_HPP
+#define KABLUNK_UTILITIES_CONTAINER_FLAT_UNORDERED_HASH_SET_HPP
+
+#include "flat_unordered_hash_map.hpp"
+
+namespace Kablunk::util::container
+{ // start namespace Kablunk::util::container
+
+// flat unordered hash set for membership tests and deduplication
+// built on the same swiss table as flat_unordered_hash_map, slots store the bare key (no value, not even a padding byte)
+// so probing, metadata, growth, tombstones and incremental rebuilds behave exactly like the map
+// set algebra (insert_range, intersect, contains_all) probes keys in batches, prefetching a batch's groups before comparing keys
+template <
+	typename K,
+	typename Hash = hash::hasher<K>,
+	typename KeyEqual = hash::key_equal<K>,
+	typename Allocator = std::allocator<K>,
+	bool StoreHash = false
+>
+class flat_unordered_hash_set
+{
+public:
+	using key_t = K;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using allocator_t = Allocator;
+	using slot_t = details::hash_map_pair<key_t, details::hash_set_value>;
+	using slot_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<slot_t>;
+	using map_t = flat_unordered_hash_map<key_t, details::hash_set_value, hasher_t, key_equal_t, slot_allocator_t, StoreHash>;
+	// key types accepted by the lookups, see flat_unordered_hash_map's heterogeneous lookups
+	template <typename key_arg_t>
+	using enable_if_lookup_key_t = typename map_t::template enable_if_lookup_key_t<key_arg_t>;
+public:
+	// const iterator over the keys of the set, keys can not be modified in-place
+	class citerator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = key_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const key_t*;
+		using reference = const key_t&;
+
+		// default constructor
+		citerator() = default;
+		// constructor that wraps an iterator of the underlying map
+		explicit citerator(const typename map_t::citerator& it)
+			: m_it{ it }
+		{ }
+
+		// dereferencing operator
+		const key_t& operator*() const { return (*m_it).key; }
+		// member access operator
+		const key_t* operator->() const { return &(*m_it).key; }
+
+		// equality comparison operator
+		bool operator==(const citerator& other) const { return m_it == other.m_it; }
+		// inequality comparison operator
+		bool operator!=(const citerator& other) const { return !(*this == other); }
+
+		// prefix increment operator
+		citerator& operator++()
+		{
+			++m_it;
+			return *this;
+		}
+	private:
+		// iterator of the underlying map
+		typename map_t::citerator m_it{};
+	};
+public:
+	// default constructor, allocates nothing until the first insertion
+	flat_unordered_hash_set() = default;
+	// constructor with a custom allocator
+	explicit flat_unordered_hash_set(const allocator_t& allocator)
+		: m_map{ slot_allocator_t{ allocator } }
+	{ }
+	// constructor with a custom hash, key equality function, and allocator
+	explicit flat_unordered_hash_set(const hasher_t& hasher, const key_equal_t& key_equal = key_equal_t{}, const allocator_t& allocator = allocator_t{})
+		: m_map{ hasher, key_equal, slot_allocator_t{ allocator } }
+	{ }
+	// constructor from a forward range of keys, a key that appears more than once is kept once
+	template <typename iterator_t>
+	flat_unordered_hash_set(iterator_t first, iterator_t last, const hasher_t& hasher = hasher_t{}, const key_equal_t& key_equal = key_equal_t{}, const allocator_t& allocator = allocator_t{})
+		: m_map{ hasher, key_equal, slot_allocator_t{ allocator } }
+	{
+		insert_range(first, last);
+	}
+	flat_unordered_hash_set(const flat_unordered_hash_set&) = default;
+	flat_unordered_hash_set(flat_unordered_hash_set&&) noexcept = default;
+	~flat_unordered_hash_set() = default;
+
+	flat_unordered_hash_set& operator=(const flat_unordered_hash_set&) = default;
+	flat_unordered_hash_set& operator=(flat_unordered_hash_set&&) noexcept = default;
+
+	// ========
+	// capacity
+	// ========
+
+	// returns the number of keys in the set
+	inline size_t size() const { return m_map.size(); }
+	// check whether the set is empty
+	inline bool empty() const { return m_map.empty(); }
+	// returns the number of slots before the set grows, 0 until the first insertion
+	inline size_t max_size() const { return m_map.max_size(); }
+	// returns the number of bytes allocated for the metadata and key buckets
+	inline size_t get_allocated_bytes() const { return m_map.get_allocated_bytes(); }
+	// probing and occupancy statistics, see flat_unordered_hash_map::stats
+	inline details::hash_map_stats stats() const { return m_map.stats(); }
+	// zero the probing and rebuild counters
+	inline void reset_stats() { m_map.reset_stats(); }
+	// returns the allocator of the set
+	inline allocator_t get_allocator() const { return allocator_t{ m_map.get_allocator() }; }
+	// returns the hash function of the set
+	inline hasher_t get_hasher() const { return m_map.get_hasher(); }
+	// returns the key equality function of the set
+	inline key_equal_t get_key_equal() const { return m_map.get_key_equal(); }
+	// spread growth over later insertions and erasures, see flat_unordered_hash_map::set_incremental_rebuild
+	inline void set_incremental_rebuild(const size_t groups_per_operation) { m_map.set_incremental_rebuild(groups_per_operation); }
+
+	// =========
+	// modifiers
+	// =========
+
+	// insert a key, returns false if the key was already in the set
+	bool insert(const key_t& key);
+	// insert a key, returns false if the key was already in the set
+	bool insert(key_t&& key);
+	// insert a forward range of keys, keys already in the set are skipped
+	template <typename iterator_t>
+	void insert_range(iterator_t first, iterator_t last);
+	// insert every key of another set (union)
+	inline void insert_range(const flat_unordered_hash_set& other) { insert_range(other.begin(), other.end()); }
+	// erase a key, returns false if the key was not in the set
+	inline bool erase(const key_t& key) { return erase<key_t>(key); }
+	// erase a key of another type when the hasher and key equality are transparent, returns false if the key was not in the set
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	bool erase(const key_arg_t& key);
+	// keep only the keys that are also in another set (intersection)
+	void intersect(const flat_unordered_hash_set& other);
+	// destroy every key and free the buckets
+	inline void clear() { m_map.clear(); }
+	// destroy every key, keeping the current bucket size
+	inline void clear_entries() { m_map.clear_entries(); }
+	// reserve space for at least new_size slots
+	inline void reserve(const size_t new_size) { m_map.reserve(new_size); }
+	// swap the contents of two sets
+	inline void swap(flat_unordered_hash_set& other) { m_map.swap(other.m_map); }
+
+	// ======
+	// lookup
+	// ======
+
+	// check if a key is contained within the set
+	inline bool contains(const key_t& key) const { return m_map.contains(key); }
+	// check if a key of another type is contained within the set, when the hasher and key equality are transparent
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	inline bool contains(const key_arg_t& key) const { return m_map.contains(key); }
+	// finds a key, or end() if it is missing
+	inline citerator find(const key_t& key) const { return citerator{ m_map.find(key) }; }
+	// finds a key of another type, or end() if it is missing, when the hasher and key equality are transparent
+	template <typename key_arg_t, typename = enable_if_lookup_key_t<key_arg_t>>
+	inline citerator find(const key_arg_t& key) const { return citerator{ m_map.find(key) }; }
+	// check whether each key in a batch is contained within the set, out must be at least as large as keys
+	inline void contains_many(const key_t* keys, const size_t count, bool* out) const { m_map.contains_many(keys, count, out); }
+	// check whether every key of a forward range is contained within the set, stops at the first batch with a missing key
+	template <typename iterator_t>
+	bool contains_all(iterator_t first, iterator_t last) const;
+	// check whether every key of another set is contained within this set (subset test)
+	inline bool contains_all(const flat_unordered_hash_set& other) const { return other.size() <= size() && contains_all(other.begin(), other.end()); }
+
+	// =========
+	// iterators
+	// =========
+
+	// const iterator pointing to the beginning of the set
+	inline citerator begin() const { return citerator{ m_map.cbegin() }; }
+	// const iterator pointing to the end of the set
+	inline citerator end() const { return citerator{ m_map.cend() }; }
+	// const iterator pointing to the beginning of the set
+	inline citerator cbegin() const { return begin(); }
+	// const iterator pointing to the end of the set
+	inline citerator cend() const { return end(); }
+	// call function(const key_t&) on every key in the set, faster than iterating since whole metadata groups are scanned at once
+	template <typename function_t>
+	inline void for_each(function_t&& function) const { m_map.for_each([&function](const slot_t& slot) { function(slot.key); }); }
+private:
+	// number of keys probed together by the set algebra
+	static constexpr const size_t s_batch_size = map_t::s_lookup_batch_size;
+
+	// underlying map, its slots only hold keys
+	map_t m_map{};
+};
+
+// ============================
+// start implementation details
+// ============================
+
+// insert a copy of a key
+template <typename K, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+bool flat_unordered_hash_set<K, Hash, KeyEqual, Allocator, StoreHash>::insert(const key_t& key)
+{
+	const typename map_t::insert_slot_t slot = m_map.find_or_prepare_insert(key);
+	if (slot.found)
+		return false;
+
+	m_map.construct_pair_at(slot.index, slot.hash_value, key);
+	++m_map.m_element_count;
+	return true;
+}
+
+// insert a key by moving it into the set
+template <typename K, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+bool flat_unordered_hash_set<K, Hash, KeyEqual, Allocator, StoreHash>::insert(key_t&& key)
+{
+	const typename map_t::insert_slot_t slot = m_map.find_or_prepare_insert(key);
+	if (slot.found)
+		return false;
+
+	m_map.construct_pair_at(slot.index, slot.hash_value, std::move(key));
+	++m_map.m_element_count;
+	return true;
+}
+
+// insert a range of keys, keys are hashed and their home groups prefetched a batch at a time
+template <typename K, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+template <typename iterator_t>
+void flat_unordered_hash_set<K, Hash, KeyEqual, Allocator, StoreHash>::insert_range(iterator_t first, iterator_t last)
+{
+	m_map.insert_many(first, last,
+		[](const key_t& key) -> const key_t& { return key; },
+		[this](const size_t index, const typename map_t::hash_t hash_value, const key_t& key) { m_map.construct_pair_at(index, hash_value, key); }
+	);
+}
+
+// erase a key
+template <typename K, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+template <typename key_arg_t, typename>
+bool flat_unordered_hash_set<K, Hash, KeyEqual, Allocator, StoreHash>::erase(const key_arg_t& key)
+{
+	if (m_map.empty())
+		return false;
+
+	const typename map_t::hash_t hash_value = m_map.hash_key(key);
+	m_map.continue_incremental_rebuild(key, hash_value);
+
+	const size_t index = m_map.find_index_of(map_t::metadata_t::get_h1_hash(hash_value), map_t::metadata_t::get_h2_hash(hash_value), key);
+	if (!m_map.is_slot_occupied(m_map.m_metadata_bucket[index]))
+		return false;
+
+	m_map.erase_at(index);
+	return true;
+}
+
+// keep the keys that are also in another set
+// occupied slots are collected a batch at a time and looked up in the other set together, missing keys are erased in place
+// erasing only rewrites the metadata of slots that were already visited, so the scan can continue over the same bucket
+template <typename K, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void flat_unordered_hash_set<K, Hash, KeyEqual, Allocator, StoreHash>::intersect(const flat_unordered_hash_set& other)
+{
+	if (&other == this)
+		return;
+
+	if (other.empty())
+	{
+		clear_entries();
+		return;
+	}
+
+	// keys must all be in one bucket to be erased by index
+	m_map.finish_incremental_rebuild();
+
+	size_t indices[s_batch_size];
+	size_t batch_count = 0;
+	const auto flush = [this, &other, &indices, &batch_count]()
+	{
+		other.m_map.find_pairs_of_batch(batch_count,
+			[this, &indices](const size_t i) -> const key_t& { return m_map.m_bucket[indices[i]].key; },
+			[this, &indices](const size_t i, const slot_t* slot)
+			{
+				if (!slot)
+					m_map.erase_at(indices[i]);
+			}
+		);
+		batch_count = 0;
+	};
+
+	map_t::visit_occupied_slots(m_map.m_metadata_bucket, m_map.m_max_elements, [&indices, &batch_count, &flush](const size_t index)
+		{
+			indices[batch_count++] = index;
+			if (batch_count == s_batch_size)
+				flush();
+		}
+	);
+
+	if (batch_count > 0)
+		flush();
+}
+
+// check every key of a range, a batch at a time
+// keys are read through the iterators again in every pass of a batch, so iterators that return temporaries work as well
+template <typename K, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+template <typename iterator_t>
+bool flat_unordered_hash_set<K, Hash, KeyEqual, Allocator, StoreHash>::contains_all(iterator_t first, iterator_t last) const
+{
+	static_assert(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>, "contains_all requires forward iterators");
+
+	iterator_t batch[s_batch_size];
+	bool contains_every_key = true;
+	while (first != last && contains_every_key)
+	{
+		size_t batch_count = 0;
+		for (; first != last && batch_count < s_batch_size; ++first)
+			batch[batch_count++] = first;
+
+		m_map.find_pairs_of_batch(batch_count,
+			[&batch](const size_t i) -> decltype(auto) { return *batch[i]; },
+			[&contains_every_key](const size_t, const slot_t* slot) { contains_every_key &= slot != nullptr; }
+		);
+	}
+
+	return contains_every_key;
+}
+
+// ==========================
+// end implementation details
+// ==========================
+
+namespace pmr
+{ // start namespace ::pmr
+
+	// flat_unordered_hash_set that allocates from a std::pmr::memory_resource, e.g. a monotonic arena
+	template <typename K, typename Hash = hash::hasher<K>, typename KeyEqual = hash::key_equal<K>, bool StoreHash = false>
+	using flat_unordered_hash_set = container::flat_unordered_hash_set<K, Hash, KeyEqual, std::pmr::polymorphic_allocator<K>, StoreHash>;
+
+} // end namespace ::pmr
+
+} // end namespace Kablunk::util::container
+
+#endif
@@ -0,0 +1,553 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_FROZEN_FLAT_HASH_MAP_HPP
+#define KABLUNK_UTILITIES_CONTAINER_FROZEN_FLAT_HASH_MAP_HPP
+
+#include "flat_unordered_hash_map.hpp"
+
+#include <limits>
+
+namespace Kablunk::util::container
+{ // start namespace Kablunk::util::container
+
+namespace details
+{ // start namespace ::details
+
+	// high 64 bits of a 64x64 -> 128 bit multiply
+	// multiply_high(hash, n) maps a hash to [0, n) without a division (lemire's fast range)
+	inline uint64_t multiply_high(const uint64_t lhs, const uint64_t rhs)
+	{
+#if defined(__SIZEOF_INT128__)
+		return static_cast<uint64_t>((static_cast<__uint128_t>(lhs) * rhs) >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return __umulh(lhs, rhs);
+#else
+		const uint64_t lhs_lo = lhs & 0xFFFFFFFF, lhs_hi = lhs >> 32;
+		const uint64_t rhs_lo = rhs & 0xFFFFFFFF, rhs_hi = rhs >> 32;
+		const uint64_t lo_lo = lhs_lo * rhs_lo, hi_lo = lhs_hi * rhs_lo;
+		const uint64_t lo_hi = lhs_lo * rhs_hi, hi_hi = lhs_hi * rhs_hi;
+		const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+		return (hi_lo >> 32) + (cross >> 32) + hi_hi;
+#endif
+	}
+
+} // end namespace ::details
+
+// read-only map for data that is built once and then only queried
+// keys are placed with a minimal perfect hash (PTHash, Pibiri and Trani), so entries are stored densely at 100% occupancy
+//   - keys are split into buckets by their hash, and every bucket gets a small integer "pilot"
+//   - a key's slot is its hash mixed with its bucket's pilot, and pilots are searched (largest buckets first)
+//     until every key of a bucket lands in a free slot
+//   - pilots are searched in a table slightly larger than the number of keys, which keeps the search for the last buckets short,
+//     and the few keys that land past the end are remapped to the slots left free (PTHash's minimal variant)
+// a lookup is one pilot load, one slot probe and one key compare, there are no metadata bytes, h2 false positives or probe chains
+// keys whose full 64 bit hash collides with another key can not be told apart by the perfect hash, they are kept in a small fallback map
+template <
+	typename K,
+	typename V,
+	typename Hash = hash::hasher<K>,
+	typename KeyEqual = hash::key_equal<K>,
+	typename Allocator = std::allocator<details::hash_map_pair<K, V>>
+>
+class frozen_flat_hash_map
+{
+public:
+	using key_t = K;
+	using value_t = V;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using allocator_t = Allocator;
+	using hash_map_pair_t = details::hash_map_pair<key_t, value_t>;
+	using hash_t = uint64_t;
+	using pilot_t = uint16_t;
+	using map_t = flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator>;
+	using pair_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<hash_map_pair_t>;
+	using pair_allocator_traits_t = std::allocator_traits<pair_allocator_t>;
+public:
+	// empty map
+	frozen_flat_hash_map() = default;
+	// freeze the entries of a map, using its hash and key equality functions
+	template <bool StoreHash, size_t InlineCapacity>
+	explicit frozen_flat_hash_map(const flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>& map);
+	// freeze the entries of a map by moving them out, the map is left empty
+	template <bool StoreHash, size_t InlineCapacity>
+	explicit frozen_flat_hash_map(flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>&& map);
+	// freeze a random access range of pairs, when a key appears more than once its first pair is kept
+	template <typename iterator_t>
+	frozen_flat_hash_map(
+		iterator_t first,
+		iterator_t last,
+		const hasher_t& hasher = hasher_t{},
+		const key_equal_t& key_equal = key_equal_t{},
+		const allocator_t& allocator = allocator_t{}
+	);
+	frozen_flat_hash_map(const frozen_flat_hash_map& other);
+	frozen_flat_hash_map(frozen_flat_hash_map&& other) noexcept;
+	~frozen_flat_hash_map() { destroy(); }
+
+	frozen_flat_hash_map& operator=(const frozen_flat_hash_map& other);
+	frozen_flat_hash_map& operator=(frozen_flat_hash_map&& other) noexcept;
+
+	// ========
+	// capacity
+	// ========
+
+	// returns the number of key-value pairs in the map
+	inline size_t size() const { return m_element_count + (m_fallback ? m_fallback->size() : 0); }
+	// check whether the map is empty
+	inline bool empty() const { return size() == 0; }
+	// returns the number of bytes allocated for pairs, pilots, remapped slots and the fallback map
+	size_t get_allocated_bytes() const;
+
+	// ======
+	// lookup
+	// ======
+
+	// pointer to the value of a key, or nullptr if the key does not exist
+	const value_t* find(const key_t& key) const;
+	// check if a key is contained within the map
+	inline bool contains(const key_t& key) const { return find_pair(key) != nullptr; }
+	// access a specific element with bounds checking
+	const value_t& at(const key_t& key) const;
+	// call function(const hash_map_pair_t&) on every pair in the map
+	template <typename function_t>
+	void for_each(function_t&& function) const;
+private:
+	// place count pairs, get_pair(i) returns pair i as an lvalue (copied) or an rvalue (moved) reference
+	template <typename get_pair_t>
+	inline void build(const size_t count, get_pair_t&& get_pair);
+	// pair of a key, or nullptr if the key does not exist
+	inline const hash_map_pair_t* find_pair(const key_t& key) const;
+	// bucket of a hash
+	// skewed like PTHash, s_dense_key_fraction of the keys go to the first s_dense_bucket_fraction of the buckets
+	// the dense buckets are placed first while the table is still empty, which makes the search for the sparse buckets much shorter
+	inline size_t get_bucket(const hash_t hash_value) const
+	{
+		// the low bits pick the bucket, the high bits were already used to decide between dense and sparse buckets
+		const hash_t bucket_hash = hash_value * hash::s_secret[2];
+		if (hash_value < s_dense_key_threshold)
+			return static_cast<size_t>(details::multiply_high(bucket_hash, m_dense_bucket_count));
+
+		return m_dense_bucket_count + static_cast<size_t>(details::multiply_high(bucket_hash, m_bucket_count - m_dense_bucket_count));
+	}
+	// slot in the search table of a hash with a pilot, the hash is mixed again so every pilot gives an independent slot
+	inline size_t get_table_slot(const hash_t hash_value, const pilot_t pilot) const
+	{
+		const hash_t slot_hash = hash::mix_u64(hash_value ^ (static_cast<uint64_t>(pilot) * hash::s_secret[3]));
+		return static_cast<size_t>(details::multiply_high(slot_hash, m_table_size));
+	}
+	// slot in the pair bucket of a hash with a pilot
+	inline size_t get_slot(const hash_t hash_value, const pilot_t pilot) const
+	{
+		const size_t slot = get_table_slot(hash_value, pilot);
+		return slot < m_element_count ? slot : m_remapped_slots[slot - m_element_count];
+	}
+	// destroy every pair and free the buckets
+	inline void destroy();
+private:
+	// average number of keys per bucket, larger buckets need fewer pilots but take longer to place
+	static constexpr const size_t s_average_bucket_size = 3ull;
+	// fraction of keys that go to the dense buckets, as a threshold on the hash
+	static constexpr const uint64_t s_dense_key_threshold = static_cast<uint64_t>(0.6 * 18446744073709551616.0);
+	// fraction of buckets that are dense
+	static constexpr const double s_dense_bucket_fraction = 0.3;
+	// fraction of the search table filled with keys
+	static constexpr const double s_table_load_factor = 0.99;
+
+	// number of pairs placed by the perfect hash, also the size of the pair bucket
+	size_t m_element_count = 0ull;
+	// number of buckets (and pilots)
+	size_t m_bucket_count = 0ull;
+	// number of dense buckets, they come first
+	size_t m_dense_bucket_count = 0ull;
+	// number of slots pilots were searched in, at least the number of pairs
+	size_t m_table_size = 0ull;
+	// densely filled pairs
+	hash_map_pair_t* m_bucket = nullptr;
+	// pilot of every bucket
+	std::vector<pilot_t> m_pilots;
+	// pair bucket slot of every search table slot past the end of the pair bucket
+	std::vector<size_t> m_remapped_slots;
+	// keys whose full hash collides with another key, nullptr when there are none (almost always)
+	std::unique_ptr<map_t> m_fallback;
+	// allocator for the pair bucket
+	pair_allocator_t m_allocator{};
+	// hash function used to pick buckets and slots
+	hasher_t m_hasher{};
+	// equality function used to compare keys
+	key_equal_t m_key_equal{};
+};
+
+// ============================
+// start implementation details
+// ============================
+
+// copy every pair of a map
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <bool StoreHash, size_t InlineCapacity>
+frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::frozen_flat_hash_map(const flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>& map)
+	: m_allocator{ map.get_allocator() }, m_hasher{ map.get_hasher() }, m_key_equal{ map.get_key_equal() }
+{
+	std::vector<const hash_map_pair_t*> pairs;
+	pairs.reserve(map.size());
+	map.for_each([&pairs](const hash_map_pair_t& pair) { pairs.push_back(&pair); });
+
+	build(pairs.size(), [&pairs](const size_t i) -> const hash_map_pair_t& { return *pairs[i]; });
+}
+
+// move every pair out of a map
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <bool StoreHash, size_t InlineCapacity>
+frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::frozen_flat_hash_map(flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash, InlineCapacity>&& map)
+	: m_allocator{ map.get_allocator() }, m_hasher{ map.get_hasher() }, m_key_equal{ map.get_key_equal() }
+{
+	std::vector<hash_map_pair_t*> pairs;
+	pairs.reserve(map.size());
+	map.for_each([&pairs](hash_map_pair_t& pair) { pairs.push_back(&pair); });
+
+	build(pairs.size(), [&pairs](const size_t i) -> hash_map_pair_t&& { return std::move(*pairs[i]); });
+	map.clear_entries();
+}
+
+// copy every pair of a range
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename iterator_t>
+frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::frozen_flat_hash_map(
+	iterator_t first,
+	iterator_t last,
+	const hasher_t& hasher,
+	const key_equal_t& key_equal,
+	const allocator_t& allocator
+)
+	: m_allocator{ allocator }, m_hasher{ hasher }, m_key_equal{ key_equal }
+{
+	static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>,
+		"frozen_flat_hash_map requires random access iterators");
+
+	build(static_cast<size_t>(std::distance(first, last)), [first](const size_t i) -> const hash_map_pair_t& { return first[i]; });
+}
+
+// copy constructor, every slot of the pair bucket is occupied
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::frozen_flat_hash_map(const frozen_flat_hash_map& other)
+	: m_element_count{ other.m_element_count }, m_bucket_count{ other.m_bucket_count }, 
+	m_dense_bucket_count{ other.m_dense_bucket_count }, m_table_size{ other.m_table_size },
+	m_pilots{ other.m_pilots }, m_remapped_slots{ other.m_remapped_slots },
+	m_fallback{ other.m_fallback ? std::make_unique<map_t>(*other.m_fallback) : nullptr },
+	m_allocator{ pair_allocator_traits_t::select_on_container_copy_construction(other.m_allocator) },
+	m_hasher{ other.m_hasher }, m_key_equal{ other.m_key_equal }
+{
+	if (!m_element_count)
+		return;
+
+	m_bucket = pair_allocator_traits_t::allocate(m_allocator, m_element_count);
+	for (size_t i = 0; i < m_element_count; ++i)
+		new (m_bucket + i) hash_map_pair_t(other.m_bucket[i]);
+}
+
+// move constructor, the other map is left empty
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::frozen_flat_hash_map(frozen_flat_hash_map&& other) noexcept
+	: m_element_count{ std::exchange(other.m_element_count, 0) }, m_bucket_count{ std::exchange(other.m_bucket_count, 0) },
+	m_dense_bucket_count{ std::exchange(other.m_dense_bucket_count, 0) }, m_table_size{ std::exchange(other.m_table_size, 0) }, 
+	m_bucket{ std::exchange(other.m_bucket, nullptr) }, 
+	m_pilots{ std::move(other.m_pilots) }, m_remapped_slots{ std::move(other.m_remapped_slots) }, m_fallback{ std::move(other.m_fallback) },
+	m_allocator{ std::move(other.m_allocator) }, m_hasher{ std::move(other.m_hasher) }, m_key_equal{ std::move(other.m_key_equal) }
+{
+
+}
+
+// copy assign operator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>& frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::operator=(const frozen_flat_hash_map& other)
+{
+	if (this != &other)
+		*this = frozen_flat_hash_map{ other };
+
+	return *this;
+}
+
+// move assign operator, the other map is left empty
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>& frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::operator=(frozen_flat_hash_map&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	destroy();
+	m_element_count = std::exchange(other.m_element_count, 0);
+	m_bucket_count = std::exchange(other.m_bucket_count, 0);
+	m_dense_bucket_count = std::exchange(other.m_dense_bucket_count, 0);
+	m_table_size = std::exchange(other.m_table_size, 0);
+	m_bucket = std::exchange(other.m_bucket, nullptr);
+	m_pilots = std::move(other.m_pilots);
+	m_remapped_slots = std::move(other.m_remapped_slots);
+	m_fallback = std::move(other.m_fallback);
+	m_allocator = std::move(other.m_allocator);
+	m_hasher = std::move(other.m_hasher);
+	m_key_equal = std::move(other.m_key_equal);
+
+	return *this;
+}
+
+// build the perfect hash and place every pair
+// 1. keys are hashed and grouped by bucket, a key with the same full hash as an earlier key of its bucket is set aside
+// 2. buckets are visited from largest to smallest, large buckets are the hardest to place so they get the emptiest table
+// 3. for each bucket, pilots are tried in order until every key of the bucket lands in a distinct free slot of the search table,
+//    a bucket that runs out of pilots is set aside (this practically never happens, it only guarantees the search ends)
+// 4. search table slots past the end of the pair bucket are remapped to the free slots, then the pairs are constructed
+// 5. set aside keys go to the fallback map, unless they are equal to a placed key
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename get_pair_t>
+inline void frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::build(const size_t count, get_pair_t&& get_pair)
+{
+	if (count == 0)
+		return;
+
+	std::vector<hash_t> hashes(count);
+	for (size_t i = 0; i < count; ++i)
+		hashes[i] = static_cast<hash_t>(m_hasher(get_pair(i).key));
+
+	// group keys by bucket with a counting sort, keeping their order
+	// there is at least one dense and one sparse bucket
+	m_bucket_count = std::max<size_t>((count + s_average_bucket_size - 1) / s_average_bucket_size, 2);
+	m_dense_bucket_count = std::clamp<size_t>(static_cast<size_t>(static_cast<double>(m_bucket_count) * s_dense_bucket_fraction), 1, m_bucket_count - 1);
+	std::vector<size_t> bucket_begins(m_bucket_count + 1);
+	for (size_t i = 0; i < count; ++i)
+		++bucket_begins[get_bucket(hashes[i]) + 1];
+	for (size_t bucket = 0; bucket < m_bucket_count; ++bucket)
+		bucket_begins[bucket + 1] += bucket_begins[bucket];
+
+	std::vector<size_t> bucket_keys(count);
+	{
+		std::vector<size_t> cursors(bucket_begins.begin(), bucket_begins.end() - 1);
+		for (size_t i = 0; i < count; ++i)
+			bucket_keys[cursors[get_bucket(hashes[i])]++] = i;
+	}
+
+	// keys with the same full hash always land in the same slot, so only the first one can be placed
+	// buckets hold a handful of keys, so comparing every pair is cheap
+	std::vector<bool> is_set_aside(count);
+	size_t set_aside_count = 0;
+	for (size_t bucket = 0; bucket < m_bucket_count; ++bucket)
+	{
+		for (size_t position = bucket_begins[bucket]; position < bucket_begins[bucket + 1]; ++position)
+		{
+			const size_t i = bucket_keys[position];
+			for (size_t earlier_position = bucket_begins[bucket]; earlier_position < position; ++earlier_position)
+			{
+				const size_t j = bucket_keys[earlier_position];
+				if (!is_set_aside[j] && hashes[i] == hashes[j])
+				{
+					is_set_aside[i] = true;
+					++set_aside_count;
+					break;
+				}
+			}
+		}
+	}
+
+	m_table_size = static_cast<size_t>(static_cast<double>(count - set_aside_count) / s_table_load_factor) + 1;
+	m_pilots.assign(m_bucket_count, 0);
+
+	// visit buckets from largest to smallest
+	std::vector<size_t> bucket_order(m_bucket_count);
+	for (size_t bucket = 0; bucket < m_bucket_count; ++bucket)
+		bucket_order[bucket] = bucket;
+	std::stable_sort(bucket_order.begin(), bucket_order.end(), [&bucket_begins](const size_t lhs, const size_t rhs)
+		{
+			return bucket_begins[lhs + 1] - bucket_begins[lhs] > bucket_begins[rhs + 1] - bucket_begins[rhs];
+		}
+	);
+
+	std::vector<bool> is_slot_taken(m_table_size);
+	std::vector<size_t> key_slots(count);
+	std::vector<size_t> bucket_slots;
+	size_t placed_count = 0;
+	for (const size_t bucket : bucket_order)
+	{
+		const size_t bucket_begin = bucket_begins[bucket];
+		const size_t bucket_end = bucket_begins[bucket + 1];
+		if (bucket_begin == bucket_end)
+			break;
+
+		const size_t key_count = static_cast<size_t>(std::count_if(bucket_keys.begin() + bucket_begin, bucket_keys.begin() + bucket_end,
+			[&is_set_aside](const size_t i) { return !is_set_aside[i]; }));
+
+		// search for a pilot that puts every key of the bucket in a distinct free slot
+		bool is_placed = false;
+		for (size_t pilot = 0; pilot <= std::numeric_limits<pilot_t>::max() && !is_placed; ++pilot)
+		{
+			bucket_slots.clear();
+			for (size_t position = bucket_begin; position < bucket_end; ++position)
+			{
+				const size_t i = bucket_keys[position];
+				if (is_set_aside[i])
+					continue;
+
+				const size_t slot = get_table_slot(hashes[i], static_cast<pilot_t>(pilot));
+				if (is_slot_taken[slot])
+					break;
+
+				is_slot_taken[slot] = true;
+				bucket_slots.push_back(slot);
+			}
+
+			is_placed = bucket_slots.size() == key_count;
+			if (is_placed)
+				m_pilots[bucket] = static_cast<pilot_t>(pilot);
+			else
+				for (const size_t slot : bucket_slots)
+					is_slot_taken[slot] = false;
+		}
+
+		size_t slot_index = 0;
+		for (size_t position = bucket_begin; position < bucket_end; ++position)
+		{
+			const size_t i = bucket_keys[position];
+			if (is_set_aside[i])
+				continue;
+
+			if (is_placed)
+				key_slots[i] = bucket_slots[slot_index++];
+			else
+				is_set_aside[i] = true;
+		}
+
+		if (is_placed)
+			placed_count += key_count;
+	}
+
+	// every taken slot past the end of the pair bucket is matched with a free slot before it, in order
+	// there are exactly as many of both, since the pair bucket has one slot per placed key
+	m_element_count = placed_count;
+	m_remapped_slots.assign(m_table_size - m_element_count, 0);
+	size_t free_slot = 0;
+	for (size_t slot = m_element_count; slot < m_table_size; ++slot)
+	{
+		if (!is_slot_taken[slot])
+			continue;
+
+		while (is_slot_taken[free_slot])
+			++free_slot;
+		m_remapped_slots[slot - m_element_count] = free_slot++;
+	}
+
+	m_bucket = pair_allocator_traits_t::allocate(m_allocator, m_element_count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (is_set_aside[i])
+			continue;
+
+		const size_t slot = key_slots[i];
+		new (m_bucket + (slot < m_element_count ? slot : m_remapped_slots[slot - m_element_count])) hash_map_pair_t(get_pair(i));
+	}
+
+	// the fallback map keeps the first pair of equal set aside keys, and a set aside key equal to a placed key is dropped
+	// set aside keys are inserted in their original order, so the first pair of a key always wins
+	if (placed_count == count)
+		return;
+
+	m_fallback = std::make_unique<map_t>(m_hasher, m_key_equal, allocator_t{ m_allocator });
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!is_set_aside[i])
+			continue;
+
+		if (!find_pair(get_pair(i).key))
+			m_fallback->insert(get_pair(i));
+	}
+
+	if (m_fallback->empty())
+		m_fallback.reset();
+}
+
+// bytes of the pair bucket, the pilots, the remapped slots and the fallback map
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+size_t frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::get_allocated_bytes() const
+{
+	return sizeof(hash_map_pair_t) * m_element_count + sizeof(pilot_t) * m_pilots.size() + sizeof(size_t) * m_remapped_slots.size()
+		+ (m_fallback ? m_fallback->get_allocated_bytes() : 0);
+}
+
+// find a key's value
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+const V* frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::find(const K& key) const
+{
+	const hash_map_pair_t* pair = find_pair(key);
+	return pair ? &pair->value : nullptr;
+}
+
+// returns a reference to a value via key
+// asserts if the key does not exist
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+const V& frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::at(const K& key) const
+{
+	const hash_map_pair_t* pair = find_pair(key);
+
+	KB_CORE_ASSERT(pair, "key does not exist in the map!");
+
+	return pair->value;
+}
+
+// the slot picked by the key's bucket pilot is the only place the key can be, unless its hash collided while building
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline const typename frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::hash_map_pair_t* frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::find_pair(const K& key) const
+{
+	if (m_element_count)
+	{
+		const hash_t hash_value = static_cast<hash_t>(m_hasher(key));
+		const hash_map_pair_t* pair = m_bucket + get_slot(hash_value, m_pilots[get_bucket(hash_value)]);
+		if (m_key_equal(pair->key, key))
+			return pair;
+	}
+
+	if (m_fallback)
+	{
+		const auto it = static_cast<const map_t&>(*m_fallback).find(key);
+		if (it != m_fallback->cend())
+			return &*it;
+	}
+
+	return nullptr;
+}
+
+// visit the dense pairs, then the fallback map
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename function_t>
+void frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::for_each(function_t&& function) const
+{
+	for (size_t i = 0; i < m_element_count; ++i)
+		function(static_cast<const hash_map_pair_t&>(m_bucket[i]));
+
+	if (m_fallback)
+		static_cast<const map_t&>(*m_fallback).for_each(function);
+}
+
+// destroy the pairs and free the pair bucket, the pilots and fallback map free themselves
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline void frozen_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::destroy()
+{
+	if (m_bucket)
+	{
+		for (size_t i = 0; i < m_element_count; ++i)
+			m_bucket[i].~hash_map_pair_t();
+		pair_allocator_traits_t::deallocate(m_allocator, m_bucket, m_element_count);
+	}
+
+	m_bucket = nullptr;
+	m_element_count = 0;
+	m_bucket_count = 0;
+	m_dense_bucket_count = 0;
+	m_table_size = 0;
+	m_pilots.clear();
+	m_remapped_slots.clear();
+	m_fallback.reset();
+}
+
+// ==========================
+// end implementation details
+// ==========================
+
+} // end namespace Kablunk::util::container
+
+#endif
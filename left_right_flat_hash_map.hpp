@@ -0,0 +1,348 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_LEFT_RIGHT_FLAT_HASH_MAP_HPP
+#define KABLUNK_UTILITIES_CONTAINER_LEFT_RIGHT_FLAT_HASH_MAP_HPP
+
+#include "flat_unordered_hash_map.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace Kablunk::util::container
+{ // start namespace Kablunk::util::container
+
+namespace details
+{ // start namespace ::details
+
+	// index assigned to each thread the first time it reads, used to spread readers over counters
+	// sequential indices spread threads evenly, unlike hashing thread ids which are often aligned pointers
+	inline size_t get_reader_thread_index()
+	{
+		static std::atomic<size_t> s_next_index{ 0 };
+		thread_local const size_t s_index = s_next_index.fetch_add(1, std::memory_order_relaxed);
+		return s_index;
+	}
+
+} // end namespace ::details
+
+// concurrent map for read-mostly data, with wait-free lookups and a single writer at a time
+// based on the left-right technique (Ramalhete and Correia), the map keeps two copies of a flat_unordered_hash_map
+//   - readers announce themselves on a counter for the current epoch parity, then read the published copy,
+//     using the same lookup as the sequential map with no locks or retries
+//   - the writer modifies the copy readers can not see, publishes it, waits for readers that might still use the old copy
+//     (the counters of both epoch parities), and then applies the same modification to the old copy
+// the old copy is reused as the next write target instead of being freed, so a write is never a full table copy
+// costs twice the memory of a single map, and every write is applied twice
+template <
+	typename K,
+	typename V,
+	typename Hash = hash::hasher<K>,
+	typename KeyEqual = hash::key_equal<K>,
+	typename Allocator = std::allocator<details::hash_map_pair<K, V>>
+>
+class left_right_flat_hash_map
+{
+public:
+	using key_t = K;
+	using value_t = V;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using allocator_t = Allocator;
+	using map_t = flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator>;
+	using hash_map_pair_t = typename map_t::hash_map_pair_t;
+public:
+	// default constructor
+	left_right_flat_hash_map();
+	// constructor with a custom hash, key equality function, and allocator used by both copies
+	explicit left_right_flat_hash_map(const hasher_t& hasher, const key_equal_t& key_equal = key_equal_t{}, const allocator_t& allocator = allocator_t{});
+	// readers hold pointers into the map, so it can not be copied or moved
+	left_right_flat_hash_map(const left_right_flat_hash_map&) = delete;
+	left_right_flat_hash_map& operator=(const left_right_flat_hash_map&) = delete;
+
+	// ========
+	// capacity
+	// ========
+
+	// returns the number of key-value pairs in the published copy
+	size_t size() const;
+	// check whether the published copy is empty
+	bool empty() const { return size() == 0; }
+
+	// =========
+	// modifiers
+	// =========
+
+	// apply function(map_t&) to both copies and publish the result, returns the result of the first call
+	// the function must be deterministic, since it is called once per copy, and must not access this map
+	// batching several modifications in one update only waits for readers once
+	template <typename function_t>
+	auto update(function_t&& function);
+	// insert a key-value pair if the key does not exist yet, returns whether it was inserted
+	bool insert(const key_t& key, const value_t& value);
+	// insert a key-value pair, replacing the value if the key already exists
+	void insert_or_assign(const key_t& key, const value_t& value);
+	// erase a key, returns whether it was in the map
+	bool erase(const key_t& key);
+	// clear every entry, keeping the bucket sizes
+	void clear();
+	// reserve space in both copies
+	void reserve(const size_t new_size);
+
+	// ======
+	// lookup
+	// ======
+
+	// copy of the value of a key, or nothing if the key does not exist
+	std::optional<value_t> find(const key_t& key) const;
+	// check if a key is contained within the map
+	bool contains(const key_t& key) const;
+	// call function(const value_t&) on the value of a key, returns whether the key exists
+	// the writer waits while the function runs, so it should be short
+	template <typename function_t>
+	bool visit(const key_t& key, function_t&& function) const;
+	// call function(const hash_map_pair_t&) on every pair of the published copy
+	template <typename function_t>
+	void for_each(function_t&& function) const;
+private:
+	// counters of readers that are using a copy, one per epoch parity
+	// padded to a cache line, and spread over threads, so readers do not bounce each other's cache lines
+	struct alignas(details::s_cache_line_size) reader_counter_t
+	{
+		std::atomic<size_t> counts[2] = { 0, 0 };
+	};
+
+	// announces a reader for its lifetime, on the counter of the epoch parity at the time it was created
+	class reader_guard
+	{
+	public:
+		explicit reader_guard(const left_right_flat_hash_map& map)
+		{
+			const size_t epoch = map.m_epoch.load();
+			m_count = &map.m_reader_counters[details::get_reader_thread_index() & (s_reader_counter_count - 1)].counts[epoch & 1];
+			m_count->fetch_add(1);
+		}
+		~reader_guard() { m_count->fetch_sub(1, std::memory_order_release); }
+
+		reader_guard(const reader_guard&) = delete;
+		reader_guard& operator=(const reader_guard&) = delete;
+	private:
+		std::atomic<size_t>* m_count = nullptr;
+	};
+
+	// copy readers see, only valid to dereference while a reader_guard is alive
+	inline const map_t& get_published_map() const { return *m_published_map.load(); }
+	// wait until every reader that could have loaded the previously published copy is done
+	inline void wait_for_readers();
+	// wait until no reader is announced on an epoch parity
+	inline void wait_for_reader_count(const size_t parity) const;
+private:
+	// number of reader counters, must be a power of two
+	static constexpr const size_t s_reader_counter_count = 64ull;
+
+	// both copies of the map
+	map_t m_maps[2];
+	// copy readers see, the other copy is only touched by the writer
+	std::atomic<const map_t*> m_published_map{ nullptr };
+	// epoch, its parity selects the counter new readers announce themselves on
+	std::atomic<size_t> m_epoch{ 0 };
+	// reader counters
+	mutable reader_counter_t m_reader_counters[s_reader_counter_count];
+	// serializes writers
+	std::mutex m_writer_mutex;
+};
+
+// ============================
+// start implementation details
+// ============================
+
+// default constructor, publishes the first copy
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::left_right_flat_hash_map()
+{
+	m_published_map.store(&m_maps[0]);
+}
+
+// constructor with a custom hash, key equality function, and allocator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::left_right_flat_hash_map(const hasher_t& hasher, const key_equal_t& key_equal, const allocator_t& allocator)
+	: m_maps{ map_t{ hasher, key_equal, allocator }, map_t{ hasher, key_equal, allocator } }
+{
+	m_published_map.store(&m_maps[0]);
+}
+
+// size of the published copy
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+size_t left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::size() const
+{
+	const reader_guard guard{ *this };
+	return get_published_map().size();
+}
+
+// modify the hidden copy, publish it, wait for readers of the old copy, then bring the old copy up to date
+// every step uses sequentially consistent atomics, the publish store has to be ordered before the counter loads,
+// just like the reader's counter increment has to be ordered before its load of the published copy
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename function_t>
+auto left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::update(function_t&& function)
+{
+	std::lock_guard<std::mutex> lock{ m_writer_mutex };
+
+	map_t* old_map = const_cast<map_t*>(m_published_map.load());
+	map_t* new_map = old_map == &m_maps[0] ? &m_maps[1] : &m_maps[0];
+
+	if constexpr (std::is_void_v<decltype(function(*new_map))>)
+	{
+		function(*new_map);
+		m_published_map.store(new_map);
+		wait_for_readers();
+		function(*old_map);
+	}
+	else
+	{
+		auto result = function(*new_map);
+		m_published_map.store(new_map);
+		wait_for_readers();
+		function(*old_map);
+		return result;
+	}
+}
+
+// insert a pair if the key does not exist yet
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+bool left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::insert(const key_t& key, const value_t& value)
+{
+	return update([&key, &value](map_t& map)
+		{
+			const size_t old_size = map.size();
+			map.try_emplace(hash_map_pair_t{ key, value });
+			return map.size() != old_size;
+		}
+	);
+}
+
+// insert a pair, or replace the value of an existing key
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::insert_or_assign(const key_t& key, const value_t& value)
+{
+	update([&key, &value](map_t& map) { map.emplace(hash_map_pair_t{ key, value }); });
+}
+
+// erase a key from both copies
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+bool left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::erase(const key_t& key)
+{
+	return update([&key](map_t& map)
+		{
+			if (!map.contains(key))
+				return false;
+
+			map.erase(key);
+			return true;
+		}
+	);
+}
+
+// clear both copies
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::clear()
+{
+	update([](map_t& map) { map.clear_entries(); });
+}
+
+// reserve space in both copies
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::reserve(const size_t new_size)
+{
+	update([new_size](map_t& map)
+		{
+			if (map.max_size() < new_size)
+				map.reserve(new_size);
+		}
+	);
+}
+
+// copy the value out of the published copy
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+std::optional<V> left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::find(const key_t& key) const
+{
+	const reader_guard guard{ *this };
+	const map_t& map = get_published_map();
+
+	const auto it = map.find(key);
+	if (it == map.cend())
+		return std::nullopt;
+
+	return it->value;
+}
+
+// check if a key is contained within the published copy
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+bool left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::contains(const key_t& key) const
+{
+	const reader_guard guard{ *this };
+	return get_published_map().contains(key);
+}
+
+// read a value in-place in the published copy
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename function_t>
+bool left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::visit(const key_t& key, function_t&& function) const
+{
+	const reader_guard guard{ *this };
+	const map_t& map = get_published_map();
+
+	const auto it = map.find(key);
+	if (it == map.cend())
+		return false;
+
+	function(static_cast<const value_t&>(it->value));
+	return true;
+}
+
+// visit every pair of the published copy
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename function_t>
+void left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::for_each(function_t&& function) const
+{
+	const reader_guard guard{ *this };
+	get_published_map().for_each(function);
+}
+
+// flip the epoch so new readers use the other counters, and wait for both parities to drain
+//   1. readers on the next parity started before the previous flip, they might still use the old copy
+//   2. after the flip, readers on the current parity might still use the old copy
+// readers that announce themselves after the flip load the newly published copy
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline void left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::wait_for_readers()
+{
+	const size_t epoch = m_epoch.load();
+
+	wait_for_reader_count((epoch + 1) & 1);
+	m_epoch.store(epoch + 1);
+	wait_for_reader_count(epoch & 1);
+}
+
+// spin until every counter of a parity is zero, yielding to let preempted readers finish
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+inline void left_right_flat_hash_map<K, V, Hash, KeyEqual, Allocator>::wait_for_reader_count(const size_t parity) const
+{
+	for (const reader_counter_t& counter : m_reader_counters)
+	{
+		for (size_t spin_count = 0; counter.counts[parity].load() != 0; ++spin_count)
+		{
+			if (spin_count < 64)
+				details::cpu_relax();
+			else
+				std::this_thread::yield();
+		}
+	}
+}
+
+// ==========================
+// end implementation details
+// ==========================
+
+} // end namespace Kablunk::util::container
+
+#endif
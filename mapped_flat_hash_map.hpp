@@ -0,0 +1,409 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_MAPPED_FLAT_HASH_MAP_HPP
+#define KABLUNK_UTILITIES_CONTAINER_MAPPED_FLAT_HASH_MAP_HPP
+
+#include "flat_unordered_hash_map.hpp"
+
+#if defined(_WIN32)
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace Kablunk::util::container
+{ // start namespace Kablunk::util::container
+
+namespace details
+{ // start namespace ::details
+
+	// read-only memory mapping of a whole file, unmapped on destruction
+	// pages are shared with every other process mapping the same file
+	class mapped_file
+	{
+	public:
+		mapped_file() = default;
+		~mapped_file() { unmap(); }
+
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+		mapped_file(mapped_file&& other) noexcept
+			: m_data{ std::exchange(other.m_data, nullptr) }, m_size{ std::exchange(other.m_size, 0) }
+		{ }
+		mapped_file& operator=(mapped_file&& other) noexcept
+		{
+			if (this != &other)
+			{
+				unmap();
+				m_data = std::exchange(other.m_data, nullptr);
+				m_size = std::exchange(other.m_size, 0);
+			}
+			return *this;
+		}
+
+		// map a file, returns false (leaving nothing mapped) if it can not be opened or is empty
+		inline bool map(const char* path)
+		{
+			unmap();
+
+#if defined(_WIN32)
+			const HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return false;
+
+			LARGE_INTEGER file_size{};
+			if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+			{
+				CloseHandle(file);
+				return false;
+			}
+
+			// the view keeps the mapping alive, so both handles can be closed right away
+			const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(file);
+			if (!mapping)
+				return false;
+
+			const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+			if (!data)
+				return false;
+
+			m_data = static_cast<const uint8_t*>(data);
+			m_size = static_cast<size_t>(file_size.QuadPart);
+#else
+			const int file = ::open(path, O_RDONLY);
+			if (file < 0)
+				return false;
+
+			struct stat file_status{};
+			if (::fstat(file, &file_status) != 0 || file_status.st_size <= 0)
+			{
+				::close(file);
+				return false;
+			}
+
+			// the mapping keeps the file alive, so the descriptor can be closed right away
+			const size_t file_size = static_cast<size_t>(file_status.st_size);
+			void* data = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, file, 0);
+			::close(file);
+			if (data == MAP_FAILED)
+				return false;
+
+			m_data = static_cast<const uint8_t*>(data);
+			m_size = file_size;
+#endif
+			return true;
+		}
+
+		// unmap the file, does nothing if nothing is mapped
+		inline void unmap()
+		{
+			if (!m_data)
+				return;
+
+#if defined(_WIN32)
+			UnmapViewOfFile(m_data);
+#else
+			::munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+			m_data = nullptr;
+			m_size = 0;
+		}
+
+		inline const uint8_t* data() const { return m_data; }
+		inline size_t size() const { return m_size; }
+	private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+	};
+
+	// key and value of a mapped snapshot entry whose key lives in the string arena
+	// supports structured bindings, e.g. auto [key, value] = pair;
+	template <typename V>
+	struct mapped_string_pair
+	{
+		std::string_view key;
+		const V& value;
+	};
+
+} // end namespace ::details
+
+// read-only view of a snapshot written by flat_unordered_hash_map::save, served straight from a memory mapped file
+// nothing is deserialized or rehashed, lookups probe the mapped metadata and pairs in place
+// string keys (std::string, std::string_view) are looked up by std::string_view and compared against the mapped string arena
+// Hash and KeyEqual must behave like the ones of the map that wrote the snapshot, the file contents are otherwise trusted
+template <
+	typename K,
+	typename V,
+	typename Hash = hash::hasher<K>,
+	typename KeyEqual = hash::key_equal<K>
+>
+class mapped_flat_unordered_hash_map
+{
+public:
+	using key_t = K;
+	using value_t = V;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using snapshot_key_t = details::snapshot_key<key_t>;
+	// key type of the mapped pairs, a range of the string arena for string keys
+	using stored_key_t = typename snapshot_key_t::stored_key_t;
+	// key type taken by lookups, std::string_view for string keys
+	using lookup_key_t = typename snapshot_key_t::lookup_key_t;
+	using hash_map_pair_t = details::hash_map_pair<stored_key_t, value_t>;
+	using hash_t = uint64_t;
+	using metadata_t = details::swiss_table_metadata;
+	using group_t = details::metadata_group;
+	using probe_sequence_t = details::probe_sequence<group_t::s_width>;
+
+	static_assert(std::is_trivially_copyable_v<stored_key_t> && std::is_trivially_copyable_v<value_t>, "only trivially copyable or string keys, and trivially copyable values, can be mapped");
+public:
+	// empty view, nothing is mapped
+	mapped_flat_unordered_hash_map() = default;
+	mapped_flat_unordered_hash_map(const mapped_flat_unordered_hash_map&) = delete;
+	mapped_flat_unordered_hash_map& operator=(const mapped_flat_unordered_hash_map&) = delete;
+	mapped_flat_unordered_hash_map(mapped_flat_unordered_hash_map&& other) noexcept;
+	mapped_flat_unordered_hash_map& operator=(mapped_flat_unordered_hash_map&& other) noexcept;
+
+	// map a snapshot file
+	// the returned view is not mapped if the file is missing or truncated, or was written for different key or value types,
+	// a different simd backend or byte order, or with a hasher that does not match the one given here
+	static mapped_flat_unordered_hash_map map_file(const char* path, const hasher_t& hasher = hasher_t{}, const key_equal_t& key_equal = key_equal_t{});
+
+	// ========
+	// capacity
+	// ========
+
+	// whether a snapshot is mapped
+	inline bool is_mapped() const { return m_metadata_bucket != nullptr; }
+	// returns the number of key-value pairs in the snapshot
+	inline size_t size() const { return m_element_count; }
+	// check whether the snapshot is empty
+	inline bool empty() const { return m_element_count == 0; }
+	// returns the number of slots in the snapshot
+	inline size_t max_size() const { return m_max_elements; }
+
+	// ======
+	// lookup
+	// ======
+
+	// pointer to the value of a key, or nullptr if the key does not exist
+	const value_t* find(const lookup_key_t& key) const;
+	// check if a key is contained within the snapshot
+	inline bool contains(const lookup_key_t& key) const { return find(key) != nullptr; }
+	// call function(const hash_map_pair_t&) on every pair in the snapshot
+	// for string keys function(const details::mapped_string_pair<value_t>&) is called instead, with the key read from the string arena
+	template <typename function_t>
+	void for_each(function_t&& function) const;
+private:
+	// pair of a key, or nullptr if the key does not exist
+	inline const hash_map_pair_t* find_pair(const lookup_key_t& key) const;
+	// key of a mapped pair, string keys are read from the string arena
+	// a range past the end of the arena reads as an empty string instead of outside the mapping
+	inline lookup_key_t get_key(const hash_map_pair_t& pair) const;
+private:
+	// number of occupied slots whose hash is checked against their metadata when a file is mapped
+	static constexpr const size_t s_hash_check_count = 64ull;
+
+	// mapping of the whole file
+	details::mapped_file m_file;
+	// metadata bucket inside the mapping, including the sentinel
+	const metadata_t* m_metadata_bucket = nullptr;
+	// pair bucket inside the mapping
+	const hash_map_pair_t* m_bucket = nullptr;
+	// string arena inside the mapping, directly after the pair bucket, empty unless keys are strings
+	const char* m_string_arena = nullptr;
+	size_t m_string_arena_size = 0ull;
+	// number of slots, always a power of two
+	size_t m_max_elements = 0ull;
+	// number of occupied slots
+	size_t m_element_count = 0ull;
+	// hash function, must match the one of the map that wrote the snapshot
+	hasher_t m_hasher{};
+	// equality function used to compare candidate keys
+	key_equal_t m_key_equal{};
+};
+
+// ============================
+// start implementation details
+// ============================
+
+// move constructor, the other view is left unmapped
+template <typename K, typename V, typename Hash, typename KeyEqual>
+mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::mapped_flat_unordered_hash_map(mapped_flat_unordered_hash_map&& other) noexcept
+	: m_file{ std::move(other.m_file) }, m_metadata_bucket{ std::exchange(other.m_metadata_bucket, nullptr) },
+	m_bucket{ std::exchange(other.m_bucket, nullptr) }, m_string_arena{ std::exchange(other.m_string_arena, nullptr) },
+	m_string_arena_size{ std::exchange(other.m_string_arena_size, 0) }, m_max_elements{ std::exchange(other.m_max_elements, 0) },
+	m_element_count{ std::exchange(other.m_element_count, 0) }, m_hasher{ std::move(other.m_hasher) }, m_key_equal{ std::move(other.m_key_equal) }
+{
+
+}
+
+// move assign operator, the other view is left unmapped
+template <typename K, typename V, typename Hash, typename KeyEqual>
+mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>& mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::operator=(mapped_flat_unordered_hash_map&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	m_file = std::move(other.m_file);
+	m_metadata_bucket = std::exchange(other.m_metadata_bucket, nullptr);
+	m_bucket = std::exchange(other.m_bucket, nullptr);
+	m_string_arena = std::exchange(other.m_string_arena, nullptr);
+	m_string_arena_size = std::exchange(other.m_string_arena_size, 0);
+	m_max_elements = std::exchange(other.m_max_elements, 0);
+	m_element_count = std::exchange(other.m_element_count, 0);
+	m_hasher = std::move(other.m_hasher);
+	m_key_equal = std::move(other.m_key_equal);
+
+	return *this;
+}
+
+// map a snapshot and check that it can be read by this view
+// the header has to match exactly, and the first occupied slots have to be found again with the given hasher
+template <typename K, typename V, typename Hash, typename KeyEqual>
+mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual> mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::map_file(const char* path, const hasher_t& hasher, const key_equal_t& key_equal)
+{
+	mapped_flat_unordered_hash_map view;
+	view.m_hasher = hasher;
+	view.m_key_equal = key_equal;
+
+	details::mapped_file file;
+	if (!file.map(path) || file.size() < sizeof(details::snapshot_header))
+		return view;
+
+	details::snapshot_header header;
+	std::memcpy(&header, file.data(), sizeof(header));
+
+	const bool header_matches = header.magic == details::snapshot_header::s_magic
+		&& header.version == details::snapshot_header::s_version
+		&& header.group_width == group_t::s_width
+		&& header.pair_alignment == alignof(hash_map_pair_t)
+		&& header.key_size == sizeof(stored_key_t)
+		&& header.value_size == sizeof(value_t)
+		&& header.pair_size == sizeof(hash_map_pair_t)
+		&& header.key_storage == snapshot_key_t::s_storage;
+	if (!header_matches)
+		return view;
+
+	// the bucket size has to be valid and the buckets have to fit in the file
+	// the string arena takes up the rest of the file, so without one the buckets have to end exactly at the end of the file
+	const size_t max_elements = static_cast<size_t>(header.max_elements);
+	const size_t string_arena_offset = sizeof(header) + header.pair_bucket_offset + sizeof(hash_map_pair_t) * max_elements;
+	const bool layout_matches = max_elements >= group_t::s_width
+		&& (max_elements & (max_elements - 1)) == 0
+		&& header.element_count + header.deleted_count < max_elements
+		&& header.pair_bucket_offset % details::s_cache_line_size == 0
+		&& header.pair_bucket_offset >= max_elements + 1
+		&& (header.key_storage == details::snapshot_header::s_key_storage_string_arena ? file.size() >= string_arena_offset : file.size() == string_arena_offset);
+	if (!layout_matches)
+		return view;
+
+	view.m_metadata_bucket = reinterpret_cast<const metadata_t*>(file.data() + sizeof(header));
+	view.m_bucket = reinterpret_cast<const hash_map_pair_t*>(file.data() + sizeof(header) + header.pair_bucket_offset);
+	view.m_string_arena = reinterpret_cast<const char*>(file.data() + string_arena_offset);
+	view.m_string_arena_size = file.size() - string_arena_offset;
+	view.m_max_elements = max_elements;
+	view.m_element_count = static_cast<size_t>(header.element_count);
+	view.m_file = std::move(file);
+
+	// a different hasher puts keys in different slots, so they would not be found
+	size_t checked_count = 0;
+	for (size_t i = 0; i < max_elements && checked_count < s_hash_check_count; ++i)
+	{
+		if (!view.m_metadata_bucket[i].is_slot_occupied())
+			continue;
+
+		if (view.find_pair(view.get_key(view.m_bucket[i])) != view.m_bucket + i)
+			return mapped_flat_unordered_hash_map{};
+
+		++checked_count;
+	}
+
+	return view;
+}
+
+// find a key's value
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const V* mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::find(const lookup_key_t& key) const
+{
+	const hash_map_pair_t* pair = find_pair(key);
+	return pair ? &pair->value : nullptr;
+}
+
+// same probing as flat_unordered_hash_map, on the mapped buckets
+template <typename K, typename V, typename Hash, typename KeyEqual>
+inline const typename mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::hash_map_pair_t* mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::find_pair(const lookup_key_t& key) const
+{
+	if (!m_metadata_bucket)
+		return nullptr;
+
+	const hash_t hash_value = static_cast<hash_t>(m_hasher(key));
+	const uint8_t h2_hash = metadata_t::get_h2_hash(hash_value);
+	probe_sequence_t probe{ metadata_t::get_h1_hash(hash_value), m_max_elements - 1 };
+
+	while (true)
+	{
+		const group_t group{ m_metadata_bucket + probe.get_offset() };
+		for (const size_t i : group.match(h2_hash))
+		{
+			const hash_map_pair_t* pair = m_bucket + probe.get_offset(i);
+			if (m_key_equal(get_key(*pair), key))
+				return pair;
+		}
+
+		// an empty slot stops probing, the key is not in the snapshot
+		if (group.match_empty())
+			return nullptr;
+
+		probe.next();
+	}
+}
+
+// the stored key itself, or the range of the string arena it points to
+template <typename K, typename V, typename Hash, typename KeyEqual>
+inline typename mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::lookup_key_t mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::get_key(const hash_map_pair_t& pair) const
+{
+	if constexpr (snapshot_key_t::s_storage == details::snapshot_header::s_key_storage_string_arena)
+	{
+		if (pair.key.offset > m_string_arena_size || pair.key.size > m_string_arena_size - pair.key.offset)
+			return lookup_key_t{};
+
+		return lookup_key_t{ m_string_arena + pair.key.offset, static_cast<size_t>(pair.key.size) };
+	}
+	else
+		return pair.key;
+}
+
+// visit every occupied slot, scanning whole metadata groups at once
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename function_t>
+void mapped_flat_unordered_hash_map<K, V, Hash, KeyEqual>::for_each(function_t&& function) const
+{
+	for (size_t group_index = 0; group_index < m_max_elements; group_index += group_t::s_width)
+		for (const size_t i : group_t{ m_metadata_bucket + group_index }.match_full())
+		{
+			const hash_map_pair_t& pair = m_bucket[group_index + i];
+			if constexpr (snapshot_key_t::s_storage == details::snapshot_header::s_key_storage_string_arena)
+				function(details::mapped_string_pair<value_t>{ get_key(pair), pair.value });
+			else
+				function(pair);
+		}
+}
+
+// ==========================
+// end implementation details
+// ==========================
+
+} // end namespace Kablunk::util::container
+
+#endif
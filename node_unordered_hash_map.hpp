@@ -0,0 +1,569 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_NODE_UNORDERED_HASH_MAP_HPP
+#define KABLUNK_UTILITIES_CONTAINER_NODE_UNORDERED_HASH_MAP_HPP
+
+#include "flat_unordered_hash_map.hpp"
+
+namespace Kablunk::util::container
+{ // start namespace Kablunk::util::container
+
+namespace details
+{ // start namespace ::details
+
+	// value type of the map underneath node_unordered_hash_map
+	template <typename V>
+	struct node_value { };
+
+	// slot of a node_unordered_hash_map, a pointer to the pool allocated pair
+	template <typename K, typename V>
+	struct hash_map_pair<K, node_value<V>>
+	{
+		using key_t = K;
+		using value_t = node_value<V>;
+		using node_t = hash_map_pair<K, V>;
+
+		// pair the slot refers to, owned by the map's node pool
+		node_t* node = nullptr;
+
+		hash_map_pair() = default;
+		~hash_map_pair() = default;
+		explicit hash_map_pair(node_t* node)
+			: node{ node }
+		{ }
+		hash_map_pair(const hash_map_pair& other) = default;
+		hash_map_pair(hash_map_pair&& other) noexcept = default;
+
+		hash_map_pair& operator=(const hash_map_pair& other) = default;
+		hash_map_pair& operator=(hash_map_pair&& other) noexcept = default;
+	};
+
+	// key of a node slot, read through the node
+	template <typename K, typename V>
+	inline const K& get_slot_key(const hash_map_pair<K, node_value<V>>& slot) { return slot.node->key; }
+
+	// pool of nodes with stable addresses
+	// nodes are carved out of chunks that are never moved, and freed nodes are reused through an intrusive free list
+	// chunks double in size up to s_max_chunk_bytes, and are only returned to the allocator by clear() or the destructor
+	template <typename Node, typename Allocator>
+	class node_pool
+	{
+	public:
+		using node_t = Node;
+	private:
+		// storage of one node, a free node stores the next free node in its first bytes
+		union node_storage
+		{
+			node_storage* next_free;
+			alignas(node_t) unsigned char bytes[sizeof(node_t)];
+		};
+
+		using storage_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<node_storage>;
+		using storage_allocator_traits_t = std::allocator_traits<storage_allocator_t>;
+
+		// chunk of nodes allocated at once
+		struct chunk
+		{
+			node_storage* storage;
+			size_t node_count;
+		};
+	public:
+		node_pool() = default;
+		explicit node_pool(const Allocator& allocator)
+			: m_allocator{ allocator }
+		{ }
+		node_pool(const node_pool&) = delete;
+		node_pool(node_pool&& other) noexcept
+			: m_chunks{ std::move(other.m_chunks) }, m_free_list{ std::exchange(other.m_free_list, nullptr) },
+			m_chunk_cursor{ std::exchange(other.m_chunk_cursor, nullptr) }, m_chunk_end{ std::exchange(other.m_chunk_end, nullptr) },
+			m_next_chunk_node_count{ std::exchange(other.m_next_chunk_node_count, s_min_chunk_node_count) },
+			m_allocated_bytes{ std::exchange(other.m_allocated_bytes, 0) }, m_allocator{ std::move(other.m_allocator) }
+		{
+			other.m_chunks.clear();
+		}
+		// every node must already be destroyed
+		~node_pool() { clear(); }
+
+		node_pool& operator=(const node_pool&) = delete;
+		node_pool& operator=(node_pool&&) = delete;
+
+		// construct a node, reusing a freed node when there is one
+		template <typename... Args>
+		inline node_t* create(Args&&... args)
+		{
+			node_storage* storage = m_free_list;
+			if (storage)
+				m_free_list = storage->next_free;
+			else
+			{
+				if (m_chunk_cursor == m_chunk_end)
+					allocate_chunk();
+
+				storage = m_chunk_cursor++;
+			}
+
+			return new (storage->bytes) node_t(std::forward<Args>(args)...);
+		}
+		// destroy a node and keep its storage for the next node
+		inline void destroy(node_t* node)
+		{
+			node->~node_t();
+			node_storage* storage = reinterpret_cast<node_storage*>(node);
+			storage->next_free = m_free_list;
+			m_free_list = storage;
+		}
+		// free every chunk, every node must already be destroyed
+		void clear()
+		{
+			for (const chunk& chunk : m_chunks)
+				storage_allocator_traits_t::deallocate(m_allocator, chunk.storage, chunk.node_count);
+
+			m_chunks.clear();
+			m_free_list = nullptr;
+			m_chunk_cursor = nullptr;
+			m_chunk_end = nullptr;
+			m_next_chunk_node_count = s_min_chunk_node_count;
+			m_allocated_bytes = 0;
+		}
+		// swap the chunks of two pools, allocators that do not propagate must be equal
+		void swap(node_pool& other)
+		{
+			std::swap(m_chunks, other.m_chunks);
+			std::swap(m_free_list, other.m_free_list);
+			std::swap(m_chunk_cursor, other.m_chunk_cursor);
+			std::swap(m_chunk_end, other.m_chunk_end);
+			std::swap(m_next_chunk_node_count, other.m_next_chunk_node_count);
+			std::swap(m_allocated_bytes, other.m_allocated_bytes);
+			if constexpr (storage_allocator_traits_t::propagate_on_container_swap::value)
+				std::swap(m_allocator, other.m_allocator);
+		}
+		// number of bytes allocated for chunks
+		inline size_t get_allocated_bytes() const { return m_allocated_bytes; }
+	private:
+		// allocate the next chunk and make it the one nodes are carved from
+		void allocate_chunk()
+		{
+			const size_t node_count = m_next_chunk_node_count;
+			node_storage* storage = storage_allocator_traits_t::allocate(m_allocator, node_count);
+			m_chunks.push_back(chunk{ storage, node_count });
+			m_chunk_cursor = storage;
+			m_chunk_end = storage + node_count;
+			m_allocated_bytes += sizeof(node_storage) * node_count;
+			m_next_chunk_node_count = std::min(node_count * 2, s_max_chunk_node_count);
+		}
+	private:
+		// number of nodes in the first chunk
+		static constexpr const size_t s_min_chunk_node_count = 16ull;
+		// chunks stop growing once they reach this size, unless a single node is larger
+		static constexpr const size_t s_max_chunk_bytes = 1ull << 20;
+		// number of nodes in the largest chunk
+		static constexpr const size_t s_max_chunk_node_count = std::max<size_t>(s_max_chunk_bytes / sizeof(node_storage), s_min_chunk_node_count);
+
+		// every chunk allocated so far
+		std::vector<chunk> m_chunks;
+		// most recently freed node
+		node_storage* m_free_list = nullptr;
+		// next unused node of the newest chunk
+		node_storage* m_chunk_cursor = nullptr;
+		// end of the newest chunk
+		node_storage* m_chunk_end = nullptr;
+		// size of the next chunk
+		size_t m_next_chunk_node_count = s_min_chunk_node_count;
+		// bytes allocated for every chunk
+		size_t m_allocated_bytes = 0ull;
+		// allocator for the chunks
+		storage_allocator_t m_allocator{};
+	};
+
+} // end namespace ::details
+
+// unordered hash map with pointer stable pairs
+// same swiss table probing as flat_unordered_hash_map, but slots hold 8 byte pointers to pairs allocated from a node pool
+//   - growth and rehashing move only the pointers, so large (or expensive to move) values are never moved
+//   - references and pointers to pairs and values stay valid until the pair is erased, no matter how often the map grows
+// the cost is an extra indirection on every key compare, so prefer the flat map for small values
+// with StoreHash set, rebuilds never touch the nodes at all, at 8 more bytes per slot
+template <
+	typename K,
+	typename V,
+	typename Hash = hash::hasher<K>,
+	typename KeyEqual = hash::key_equal<K>,
+	typename Allocator = std::allocator<details::hash_map_pair<K, V>>,
+	bool StoreHash = false
+>
+class node_unordered_hash_map
+{
+public:
+	using key_t = K;
+	using value_t = V;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using allocator_t = Allocator;
+	using hash_map_pair_t = details::hash_map_pair<key_t, value_t>;
+	using slot_t = details::hash_map_pair<key_t, details::node_value<value_t>>;
+	using slot_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<slot_t>;
+	using map_t = flat_unordered_hash_map<key_t, details::node_value<value_t>, hasher_t, key_equal_t, slot_allocator_t, StoreHash>;
+	using pool_t = details::node_pool<hash_map_pair_t, allocator_t>;
+public:
+	// iterator over the pairs of the map
+	class iterator
+	{
+	public:
+		// default constructor
+		iterator() = default;
+		// constructor that wraps an iterator of the underlying map
+		explicit iterator(const typename map_t::iterator& it)
+			: m_it{ it }
+		{ }
+
+		// dereferencing operator
+		hash_map_pair_t& operator*() const { return *(*m_it).node; }
+		// member access operator
+		hash_map_pair_t* operator->() const { return (*m_it).node; }
+
+		// equality comparison operator
+		bool operator==(const iterator& other) const { return m_it == other.m_it; }
+		// inequality comparison operator
+		bool operator!=(const iterator& other) const { return !(*this == other); }
+
+		// prefix increment operator
+		iterator& operator++()
+		{
+			++m_it;
+			return *this;
+		}
+	private:
+		// iterator of the underlying map
+		typename map_t::iterator m_it{};
+	};
+
+	// const iterator over the pairs of the map
+	class citerator
+	{
+	public:
+		// default constructor
+		citerator() = default;
+		// constructor that wraps an iterator of the underlying map
+		explicit citerator(const typename map_t::citerator& it)
+			: m_it{ it }
+		{ }
+
+		// dereferencing operator
+		const hash_map_pair_t& operator*() const { return *(*m_it).node; }
+		// member access operator
+		const hash_map_pair_t* operator->() const { return (*m_it).node; }
+
+		// equality comparison operator
+		bool operator==(const citerator& other) const { return m_it == other.m_it; }
+		// inequality comparison operator
+		bool operator!=(const citerator& other) const { return !(*this == other); }
+
+		// prefix increment operator
+		citerator& operator++()
+		{
+			++m_it;
+			return *this;
+		}
+	private:
+		// iterator of the underlying map
+		typename map_t::citerator m_it{};
+	};
+public:
+	// default constructor, allocates nothing until the first insertion
+	node_unordered_hash_map() = default;
+	// constructor with a custom allocator
+	explicit node_unordered_hash_map(const allocator_t& allocator)
+		: m_map{ slot_allocator_t{ allocator } }, m_pool{ allocator }
+	{ }
+	// constructor with a custom hash, key equality function, and allocator
+	explicit node_unordered_hash_map(const hasher_t& hasher, const key_equal_t& key_equal = key_equal_t{}, const allocator_t& allocator = allocator_t{})
+		: m_map{ hasher, key_equal, slot_allocator_t{ allocator } }, m_pool{ allocator }
+	{ }
+	// copy constructor, every pair is copied into a node of this map's pool
+	node_unordered_hash_map(const node_unordered_hash_map& other);
+	// move constructor, pairs keep their addresses
+	node_unordered_hash_map(node_unordered_hash_map&& other) noexcept = default;
+	// destructor
+	~node_unordered_hash_map() { destroy_nodes(); }
+
+	// copy assign operator
+	node_unordered_hash_map& operator=(const node_unordered_hash_map& other);
+	// move assign operator
+	node_unordered_hash_map& operator=(node_unordered_hash_map&& other) noexcept;
+
+	// ========
+	// capacity
+	// ========
+
+	// check whether the map is empty
+	inline bool empty() const { return m_map.empty(); }
+	// returns the number of key-value pairs in the map
+	inline size_t size() const { return m_map.size(); }
+	// returns the number of slots before the map grows, 0 until the first insertion
+	inline size_t max_size() const { return m_map.max_size(); }
+	// returns the number of bytes allocated for the metadata and slot buckets and the node pool
+	inline size_t get_allocated_bytes() const { return m_map.get_allocated_bytes() + m_pool.get_allocated_bytes(); }
+	// probing and occupancy statistics of the slot bucket, see flat_unordered_hash_map::stats
+	// the allocated bytes include the node pool
+	inline details::hash_map_stats stats() const
+	{
+		details::hash_map_stats result = m_map.stats();
+		result.allocated_bytes = get_allocated_bytes();
+		return result;
+	}
+	// zero the probing and rebuild counters
+	inline void reset_stats() { m_map.reset_stats(); }
+	// spread growth over later insertions and erasures, see flat_unordered_hash_map::set_incremental_rebuild
+	inline void set_incremental_rebuild(const size_t groups_per_operation) { m_map.set_incremental_rebuild(groups_per_operation); }
+	// returns a copy of the allocator used by the map
+	inline allocator_t get_allocator() const { return allocator_t{ m_map.get_allocator() }; }
+	// returns a copy of the hash function used by the map
+	inline hasher_t get_hasher() const { return m_map.get_hasher(); }
+	// returns a copy of the key equality function used by the map
+	inline key_equal_t get_key_equal() const { return m_map.get_key_equal(); }
+
+	// =========
+	// modifiers
+	// =========
+
+	// destroy every pair and free memory
+	void clear();
+	// insert a pair, *safely* fails if the key is already present
+	inline void insert(const hash_map_pair_t& pair) { try_emplace(pair.key, pair.value); }
+	// insert a pair, *safely* fails if the key is already present
+	inline void insert(hash_map_pair_t&& pair) { try_emplace(std::move(pair.key), std::move(pair.value)); }
+	// insert a pair via key and value, *safely* fails if the key is already present
+	inline void insert(const key_t& key, const value_t& value) { try_emplace(key, value); }
+	// insert a pair, an existing pair with the same key has its value assigned in place
+	void emplace(key_t&& key, value_t&& value);
+	// construct a value in-place if the key does not exist, returns the pair of the key either way
+	template <typename key_arg_t, typename... Args>
+	hash_map_pair_t& try_emplace(key_arg_t&& key, Args&&... args);
+	// erase a pair, its node is returned to the pool
+	void erase(const key_t& key);
+	// swap the contents, pairs keep their addresses
+	void swap(node_unordered_hash_map& other);
+	// reserve *more* slots for the map, the size is rounded up to the next power of two
+	inline void reserve(const size_t new_size) { m_map.reserve(new_size); }
+
+	// ======
+	// lookup
+	// ======
+
+	// access a specific element with bounds checking
+	value_t& at(const key_t& key);
+	// access a specific element with bounds checking
+	const value_t& at(const key_t& key) const;
+	// access or insert (default construct) a specific element, the reference stays valid until the key is erased
+	inline value_t& operator[](const key_t& key) { return try_emplace(key).value; }
+	// finds the element with a certain key
+	inline iterator find(const key_t& key) { return iterator{ m_map.find(key) }; }
+	// finds the element with a certain key
+	inline citerator find(const key_t& key) const { return citerator{ m_map.find(key) }; }
+	// check if a key is contained within the map
+	inline bool contains(const key_t& key) const { return m_map.contains(key); }
+
+	// =========
+	// iterators
+	// =========
+
+	// iterator pointing to the beginning of the map
+	inline iterator begin() { return iterator{ m_map.begin() }; }
+	// iterator pointing to the end of the map
+	inline iterator end() { return iterator{ m_map.end() }; }
+	// const iterator pointing to the beginning of the map
+	inline citerator begin() const { return cbegin(); }
+	// const iterator pointing to the end of the map
+	inline citerator end() const { return cend(); }
+	// const iterator pointing to the beginning of the map
+	inline citerator cbegin() const { return citerator{ m_map.cbegin() }; }
+	// const iterator pointing to the end of the map
+	inline citerator cend() const { return citerator{ m_map.cend() }; }
+	// call function(hash_map_pair_t&) on every pair in the map, faster than iterating since whole metadata groups are scanned at once
+	template <typename function_t>
+	inline void for_each(function_t&& function) { m_map.for_each([&function](slot_t& slot) { function(*slot.node); }); }
+	// call function(const hash_map_pair_t&) on every pair in the map
+	template <typename function_t>
+	inline void for_each(function_t&& function) const { m_map.for_each([&function](const slot_t& slot) { function(static_cast<const hash_map_pair_t&>(*slot.node)); }); }
+private:
+	// destroy the pair of every slot, slots and chunks are left for the caller to free
+	inline void destroy_nodes();
+private:
+	// swiss table of node pointers
+	map_t m_map{};
+	// pool every pair is allocated from
+	pool_t m_pool{};
+};
+
+// ============================
+// start implementation details
+// ============================
+
+// copy constructor
+// the slots are copied as they are (same bucket size and layout), then every slot is pointed at a copy of its pair
+// if copying a pair throws, the copies made so far are destroyed, the pool would otherwise free them without their destructors
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::node_unordered_hash_map(const node_unordered_hash_map& other)
+	: m_map{ other.m_map },
+	m_pool{ std::allocator_traits<allocator_t>::select_on_container_copy_construction(other.get_allocator()) }
+{
+	// slots are visited in the same order both times, so the first copied_count slots hold the copies
+	size_t copied_count = 0;
+	details::scope_rollback rollback{ [this, &copied_count]()
+		{
+			m_map.for_each([this, &copied_count](slot_t& slot)
+				{
+					if (copied_count == 0)
+						return;
+
+					--copied_count;
+					m_pool.destroy(slot.node);
+				}
+			);
+		}
+	};
+
+	m_map.for_each([this, &copied_count](slot_t& slot)
+		{
+			slot.node = m_pool.create(static_cast<const hash_map_pair_t&>(*slot.node));
+			++copied_count;
+		}
+	);
+	rollback.dismiss();
+}
+
+// copy assign operator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>& node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::operator=(const node_unordered_hash_map& other)
+{
+	if (this != &other)
+	{
+		node_unordered_hash_map copy{ other };
+		swap(copy);
+	}
+
+	return *this;
+}
+
+// move assign operator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>& node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::operator=(node_unordered_hash_map&& other) noexcept
+{
+	if (this != &other)
+	{
+		clear();
+		swap(other);
+	}
+
+	return *this;
+}
+
+// destroy every pair, then free the slot bucket and the pool's chunks
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::clear()
+{
+	destroy_nodes();
+	m_map.clear();
+	m_pool.clear();
+}
+
+// insert a pair, or assign the value of an existing one
+// the existing node is kept, so references to it stay valid and a throwing assignment leaves the pair intact
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::emplace(key_t&& key, value_t&& value)
+{
+	const typename map_t::insert_slot_t slot = m_map.find_or_prepare_insert(key);
+	if (slot.found)
+	{
+		m_map.m_bucket[slot.index].node->value = std::move(value);
+		return;
+	}
+
+	m_map.construct_pair_at(slot.index, slot.hash_value, m_pool.create(std::move(key), std::move(value)));
+	++m_map.m_element_count;
+}
+
+// construct the value of a missing key in-place
+// the node is only created once the key is known to be missing, so an existing pair costs nothing but the lookup
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+template <typename key_arg_t, typename... Args>
+details::hash_map_pair<K, V>& node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::try_emplace(key_arg_t&& key, Args&&... args)
+{
+	const typename map_t::insert_slot_t slot = m_map.find_or_prepare_insert(key);
+	if (slot.found)
+		return *m_map.m_bucket[slot.index].node;
+
+	hash_map_pair_t* node = m_pool.create(std::piecewise_construct, std::forward<key_arg_t>(key), std::forward<Args>(args)...);
+	m_map.construct_pair_at(slot.index, slot.hash_value, node);
+	++m_map.m_element_count;
+	return *node;
+}
+
+// erase a pair
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::erase(const key_t& key)
+{
+	if (m_map.empty())
+		return;
+
+	const typename map_t::hash_t hash_value = m_map.hash_key(key);
+	m_map.continue_incremental_rebuild(key, hash_value);
+
+	const size_t index = m_map.find_index_of(map_t::metadata_t::get_h1_hash(hash_value), map_t::metadata_t::get_h2_hash(hash_value), key);
+	if (!m_map.is_slot_occupied(m_map.m_metadata_bucket[index]))
+	{
+#ifdef KB_DEBUG
+		KB_CORE_ASSERT(false, "key does not exist in map!");
+#endif
+		return;
+	}
+
+	hash_map_pair_t* node = m_map.m_bucket[index].node;
+	m_map.erase_at(index);
+	m_pool.destroy(node);
+}
+
+// swap the contents
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::swap(node_unordered_hash_map& other)
+{
+	m_map.swap(other.m_map);
+	m_pool.swap(other.m_pool);
+}
+
+// access a specific element with bounds checking
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+V& node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::at(const K& key)
+{
+	slot_t* slot = m_map.find_pair(key);
+
+	KB_CORE_ASSERT(slot, "key does not exist in the map!");
+
+	return slot->node->value;
+}
+
+// access a specific element with bounds checking
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+const V& node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::at(const K& key) const
+{
+	const slot_t* slot = m_map.find_pair(key);
+
+	KB_CORE_ASSERT(slot, "key does not exist in the map!");
+
+	return slot->node->value;
+}
+
+// destroy every pair, nodes of trivially destructible pairs are simply dropped with their chunks
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+inline void node_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::destroy_nodes()
+{
+	if constexpr (!std::is_trivially_destructible_v<hash_map_pair_t>)
+		m_map.for_each([](slot_t& slot) { slot.node->~hash_map_pair_t(); });
+}
+
+// ==========================
+// end implementation details
+// ==========================
+
+} // end namespace Kablunk::util::container
+
+#endif
@@ -0,0 +1,357 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_SHARDED_FLAT_HASH_MAP_HPP
+#define KABLUNK_UTILITIES_CONTAINER_SHARDED_FLAT_HASH_MAP_HPP
+
+#include "flat_unordered_hash_map.hpp"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+
+namespace Kablunk::util::container
+{ // start namespace Kablunk::util::container
+
+namespace details
+{ // start namespace ::details
+
+	// test and test-and-set spin lock, for shards where the critical section is a single short map operation
+	// shared locking is exclusive, so it can be used anywhere a reader-writer lock is expected
+	class spin_lock
+	{
+	public:
+		// spin on a plain load until the lock looks free, so waiting threads do not bounce the cache line
+		inline void lock()
+		{
+			while (m_locked.exchange(true, std::memory_order_acquire))
+				while (m_locked.load(std::memory_order_relaxed))
+					cpu_relax();
+		}
+		inline bool try_lock() { return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire); }
+		inline void unlock() { m_locked.store(false, std::memory_order_release); }
+
+		inline void lock_shared() { lock(); }
+		inline bool try_lock_shared() { return try_lock(); }
+		inline void unlock_shared() { unlock(); }
+	private:
+		std::atomic<bool> m_locked{ false };
+	};
+
+	// log2 of a power of two
+	constexpr uint32_t log2_of_power_of_two(const size_t value)
+	{
+		uint32_t result = 0;
+		while ((1ull << result) < value)
+			++result;
+		return result;
+	}
+
+} // end namespace ::details
+
+// thread-safe map that splits keys over a number of independently locked flat_unordered_hash_maps (shards)
+// threads working on different shards never contend, and each shard sits on its own cache lines
+// references into a shard are never handed out, values are copied out or accessed through a callback while the shard is locked
+template <
+	typename K,
+	typename V,
+	size_t Shards = 64,
+	typename Hash = hash::hasher<K>,
+	typename KeyEqual = hash::key_equal<K>,
+	typename Lock = std::shared_mutex,
+	typename Allocator = std::allocator<details::hash_map_pair<K, V>>
+>
+class sharded_flat_hash_map
+{
+public:
+	using key_t = K;
+	using value_t = V;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using lock_t = Lock;
+	using allocator_t = Allocator;
+	using map_t = flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator>;
+	using hash_map_pair_t = typename map_t::hash_map_pair_t;
+	using hash_t = uint64_t;
+
+	static_assert(Shards > 0 && (Shards & (Shards - 1)) == 0, "shard count must be a power of two!");
+public:
+	// default constructor
+	sharded_flat_hash_map() = default;
+	// constructor with a custom hash, key equality function, and allocator shared by every shard
+	explicit sharded_flat_hash_map(const hasher_t& hasher, const key_equal_t& key_equal = key_equal_t{}, const allocator_t& allocator = allocator_t{});
+	// shards own locks, so the map can not be copied or moved
+	sharded_flat_hash_map(const sharded_flat_hash_map&) = delete;
+	sharded_flat_hash_map& operator=(const sharded_flat_hash_map&) = delete;
+
+	// ========
+	// capacity
+	// ========
+
+	// number of shards
+	static constexpr size_t get_shard_count() { return Shards; }
+	// returns the number of key-value pairs in the map
+	// shards are counted one at a time, so the result is only a snapshot when other threads modify the map
+	size_t size() const;
+	// check whether the map is empty, a snapshot like size()
+	bool empty() const { return size() == 0; }
+
+	// =========
+	// modifiers
+	// =========
+
+	// insert a key-value pair if the key does not exist yet, returns whether it was inserted
+	bool insert(const key_t& key, const value_t& value);
+	// insert a key-value pair, replacing the value if the key already exists
+	void insert_or_assign(const key_t& key, const value_t& value);
+	// erase a key, returns whether it was in the map
+	bool erase(const key_t& key);
+	// clear every shard, keeping their bucket sizes
+	void clear();
+	// reserve space for a total number of elements, spread evenly over the shards
+	void reserve(const size_t new_size);
+
+	// ======
+	// lookup
+	// ======
+
+	// copy of the value of a key, or nothing if the key does not exist
+	std::optional<value_t> find(const key_t& key) const;
+	// check if a key is contained within the map
+	bool contains(const key_t& key) const;
+	// call function(value_t&) on the value of a key while its shard is exclusively locked, returns whether the key exists
+	// the function must not access this map
+	template <typename function_t>
+	bool visit(const key_t& key, function_t&& function);
+	// call function(const value_t&) on the value of a key while its shard is shared locked, returns whether the key exists
+	// the function must not modify this map
+	template <typename function_t>
+	bool visit(const key_t& key, function_t&& function) const;
+	// call function(const hash_map_pair_t&) on every pair, locking one shard at a time
+	// the function must not access this map
+	template <typename function_t>
+	void for_each(function_t&& function) const;
+private:
+	// a map and its lock, aligned so neighbouring shards never share a cache line
+	struct alignas(details::s_cache_line_size) shard_t
+	{
+		// lock protecting the map
+		mutable lock_t lock;
+		// map holding every key routed to this shard
+		map_t map;
+	};
+
+	// full hash of a key, computed before the shard is locked and passed on to the shard's map so a key is hashed once
+	inline hash_t hash_key(const key_t& key) const { return static_cast<hash_t>(m_hasher(key)); }
+	// shard a hash is routed to
+	inline shard_t& get_shard(const hash_t hash_value) { return m_shards[get_shard_index(hash_value)]; }
+	// shard a hash is routed to
+	inline const shard_t& get_shard(const hash_t hash_value) const { return m_shards[get_shard_index(hash_value)]; }
+	// route with the hash bits right below the h2 bits
+	// shards only use the low bits of h1 to index their bucket and all 7 bits of h2 as metadata,
+	// so keys of the same shard do not collide any more often than in a single map
+	static inline size_t get_shard_index(const hash_t hash_value)
+	{
+		return static_cast<size_t>(hash_value >> (0x39 - s_shard_bits)) & (Shards - 1);
+	}
+private:
+	// number of hash bits used to pick a shard
+	static constexpr const uint32_t s_shard_bits = details::log2_of_power_of_two(Shards);
+
+	// shards, each with its own lock
+	std::array<shard_t, Shards> m_shards{};
+	// hash function used to route keys, shards use a copy of it
+	hasher_t m_hasher{};
+};
+
+// ============================
+// start implementation details
+// ============================
+
+// constructor with a custom hash, key equality function, and allocator
+// every shard gets a copy of each
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::sharded_flat_hash_map(const hasher_t& hasher, const key_equal_t& key_equal, const allocator_t& allocator)
+	: m_hasher{ hasher }
+{
+	for (shard_t& shard : m_shards)
+		shard.map = map_t{ hasher, key_equal, allocator };
+}
+
+// sum of the shard sizes
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+size_t sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::size() const
+{
+	size_t size = 0;
+	for (const shard_t& shard : m_shards)
+	{
+		std::shared_lock<lock_t> lock{ shard.lock };
+		size += shard.map.size();
+	}
+
+	return size;
+}
+
+// insert a pair if the key does not exist yet
+// the key is hashed before locking, and the pair is only constructed once the key is known to be missing
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+bool sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::insert(const key_t& key, const value_t& value)
+{
+	const hash_t hash_value = hash_key(key);
+	shard_t& shard = get_shard(hash_value);
+	std::unique_lock<lock_t> lock{ shard.lock };
+
+	const typename map_t::insert_slot_t slot = shard.map.find_or_prepare_insert(key, hash_value);
+	if (slot.found)
+		return false;
+
+	shard.map.construct_pair_at(slot.index, slot.hash_value, key, value);
+	++shard.map.m_element_count;
+	return true;
+}
+
+// insert a pair, or replace the value of an existing key
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+void sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::insert_or_assign(const key_t& key, const value_t& value)
+{
+	const hash_t hash_value = hash_key(key);
+	shard_t& shard = get_shard(hash_value);
+	std::unique_lock<lock_t> lock{ shard.lock };
+
+	const typename map_t::insert_slot_t slot = shard.map.find_or_prepare_insert(key, hash_value);
+	if (slot.found)
+	{
+		shard.map.m_bucket[slot.index].value = value;
+		return;
+	}
+
+	shard.map.construct_pair_at(slot.index, slot.hash_value, key, value);
+	++shard.map.m_element_count;
+}
+
+// erase a key from its shard with a single probe
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+bool sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::erase(const key_t& key)
+{
+	const hash_t hash_value = hash_key(key);
+	shard_t& shard = get_shard(hash_value);
+	std::unique_lock<lock_t> lock{ shard.lock };
+
+	map_t& map = shard.map;
+	if (map.empty())
+		return false;
+
+	map.continue_incremental_rebuild(key, hash_value);
+
+	const size_t index = map.find_index_of(map_t::metadata_t::get_h1_hash(hash_value), map_t::metadata_t::get_h2_hash(hash_value), key);
+	if (!map.is_slot_occupied(map.m_metadata_bucket[index]))
+		return false;
+
+	map.erase_at(index);
+	return true;
+}
+
+// clear every shard, one at a time
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+void sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::clear()
+{
+	for (shard_t& shard : m_shards)
+	{
+		std::unique_lock<lock_t> lock{ shard.lock };
+		shard.map.clear_entries();
+	}
+}
+
+// reserve space in every shard
+// the hash spreads keys evenly, so each shard gets an equal part (rounded up by the shard to a power of two)
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+void sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::reserve(const size_t new_size)
+{
+	const size_t shard_size = (new_size + Shards - 1) / Shards;
+	for (shard_t& shard : m_shards)
+	{
+		std::unique_lock<lock_t> lock{ shard.lock };
+		if (shard.map.max_size() < shard_size)
+			shard.map.reserve(shard_size);
+	}
+}
+
+// copy the value out while the shard is shared locked
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+std::optional<V> sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::find(const key_t& key) const
+{
+	const hash_t hash_value = hash_key(key);
+	const shard_t& shard = get_shard(hash_value);
+	std::shared_lock<lock_t> lock{ shard.lock };
+
+	const hash_map_pair_t* pair = shard.map.find_pair(key, hash_value);
+	if (!pair)
+		return std::nullopt;
+
+	return pair->value;
+}
+
+// check if a key is contained within its shard
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+bool sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::contains(const key_t& key) const
+{
+	const hash_t hash_value = hash_key(key);
+	const shard_t& shard = get_shard(hash_value);
+	std::shared_lock<lock_t> lock{ shard.lock };
+
+	return shard.map.find_pair(key, hash_value) != nullptr;
+}
+
+// modify a value in-place while its shard is exclusively locked
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+template <typename function_t>
+bool sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::visit(const key_t& key, function_t&& function)
+{
+	const hash_t hash_value = hash_key(key);
+	shard_t& shard = get_shard(hash_value);
+	std::unique_lock<lock_t> lock{ shard.lock };
+
+	hash_map_pair_t* pair = shard.map.find_pair(key, hash_value);
+	if (!pair)
+		return false;
+
+	function(pair->value);
+	return true;
+}
+
+// read a value in-place while its shard is shared locked
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+template <typename function_t>
+bool sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::visit(const key_t& key, function_t&& function) const
+{
+	const hash_t hash_value = hash_key(key);
+	const shard_t& shard = get_shard(hash_value);
+	std::shared_lock<lock_t> lock{ shard.lock };
+
+	const hash_map_pair_t* pair = shard.map.find_pair(key, hash_value);
+	if (!pair)
+		return false;
+
+	function(static_cast<const value_t&>(pair->value));
+	return true;
+}
+
+// visit every pair, shard by shard
+template <typename K, typename V, size_t Shards, typename Hash, typename KeyEqual, typename Lock, typename Allocator>
+template <typename function_t>
+void sharded_flat_hash_map<K, V, Shards, Hash, KeyEqual, Lock, Allocator>::for_each(function_t&& function) const
+{
+	for (const shard_t& shard : m_shards)
+	{
+		std::shared_lock<lock_t> lock{ shard.lock };
+		shard.map.for_each(function);
+	}
+}
+
+// ==========================
+// end implementation details
+// ==========================
+
+} // end namespace Kablunk::util::container
+
+#endif
@@ -0,0 +1,600 @@
+#pragma once
+#ifndef KABLUNK_UTILITIES_CONTAINER_SPLIT_FLAT_UNORDERED_HASH_MAP_HPP
+#define KABLUNK_UTILITIES_CONTAINER_SPLIT_FLAT_UNORDERED_HASH_MAP_HPP
+
+#include "flat_unordered_hash_map.hpp"
+
+namespace Kablunk::util::container
+{ // start namespace Kablunk::util::container
+
+namespace details
+{ // start namespace ::details
+
+	// value type of the map underneath split_flat_unordered_hash_map
+	template <typename V>
+	struct split_value { };
+
+	// slot of a split_flat_unordered_hash_map, the key and the index of its value in the value array
+	template <typename K, typename V>
+	struct hash_map_pair<K, split_value<V>>
+	{
+		using key_t = K;
+		using value_t = split_value<V>;
+
+		// key that is used to hash and store the pair
+		key_t key{};
+		// index of the value in the value array
+		uint32_t value_index = 0;
+
+		hash_map_pair() = default;
+		~hash_map_pair() = default;
+		template <typename key_arg_t>
+		hash_map_pair(key_arg_t&& key, const uint32_t value_index)
+			: key(std::forward<key_arg_t>(key)), value_index{ value_index }
+		{ }
+		hash_map_pair(const hash_map_pair& other) = default;
+		hash_map_pair(hash_map_pair&& other) noexcept = default;
+
+		hash_map_pair& operator=(const hash_map_pair& other) = default;
+		hash_map_pair& operator=(hash_map_pair&& other) noexcept = default;
+	};
+
+	// key and value of a split_flat_unordered_hash_map entry, the two live in different arrays
+	// supports structured bindings, e.g. auto [key, value] = *it;
+	template <typename K, typename V>
+	struct split_pair_reference
+	{
+		const K& key;
+		V& value;
+	};
+
+	// array of values addressed by index, freed indices are reused before the array grows
+	// the array only holds values, which live entries own which index is tracked by the slots of the map
+	// so anything that has to touch every live value (growth, copies, clearing) is handed a visitor over the live indices
+	template <typename V, typename Allocator>
+	class split_value_array
+	{
+	public:
+		using value_t = V;
+		using allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<value_t>;
+		using allocator_traits_t = std::allocator_traits<allocator_t>;
+	public:
+		split_value_array() = default;
+		explicit split_value_array(const Allocator& allocator)
+			: m_allocator{ allocator }
+		{ }
+		split_value_array(const split_value_array&) = delete;
+		split_value_array(split_value_array&& other) noexcept
+			: m_values{ std::exchange(other.m_values, nullptr) }, m_used_count{ std::exchange(other.m_used_count, 0) },
+			m_capacity{ std::exchange(other.m_capacity, 0) }, m_free_indices{ std::move(other.m_free_indices) },
+			m_allocator{ std::move(other.m_allocator) }
+		{
+			other.m_free_indices.clear();
+		}
+		// every value must already be destroyed
+		~split_value_array() { deallocate(); }
+
+		split_value_array& operator=(const split_value_array&) = delete;
+		split_value_array& operator=(split_value_array&&) = delete;
+
+		// access the value at an index
+		inline value_t& operator[](const uint32_t index) { return m_values[index]; }
+		// access the value at an index
+		inline const value_t& operator[](const uint32_t index) const { return m_values[index]; }
+
+		// whether the next create() needs the array to grow first
+		inline bool is_full() const { return m_free_indices.empty() && m_used_count == m_capacity; }
+		// construct a value, the array must not be full
+		template <typename... Args>
+		inline uint32_t create(Args&&... args)
+		{
+			uint32_t index;
+			if (!m_free_indices.empty())
+			{
+				index = m_free_indices.back();
+				m_free_indices.pop_back();
+			}
+			else
+				index = static_cast<uint32_t>(m_used_count++);
+
+			allocator_traits_t::construct(m_allocator, m_values + index, std::forward<Args>(args)...);
+			return index;
+		}
+		// destroy a value and keep its index for the next value
+		inline void destroy(const uint32_t index)
+		{
+			allocator_traits_t::destroy(m_allocator, m_values + index);
+			m_free_indices.push_back(index);
+		}
+		// move every live value into a larger allocation, indices do not change
+		// visit_live(function) must call function(index) for the index of every live value
+		template <typename visit_live_t>
+		void grow(const size_t new_capacity, visit_live_t&& visit_live)
+		{
+			KB_CORE_ASSERT(new_capacity <= s_max_capacity, "split map can not hold more than 2^32 - 1 values!");
+
+			value_t* new_values = allocator_traits_t::allocate(m_allocator, new_capacity);
+			visit_live([this, new_values](const uint32_t index)
+				{
+					allocator_traits_t::construct(m_allocator, new_values + index, std::move(m_values[index]));
+					allocator_traits_t::destroy(m_allocator, m_values + index);
+				}
+			);
+
+			deallocate();
+			m_values = new_values;
+			m_capacity = new_capacity;
+		}
+		// copy the values of another array to the same indices, this array must be empty
+		// if copying a value throws, the copies made so far are destroyed, freeing the array does not run their destructors
+		template <typename visit_live_t>
+		void copy_from(const split_value_array& other, visit_live_t&& visit_live)
+		{
+			if (!other.m_capacity)
+				return;
+
+			m_values = allocator_traits_t::allocate(m_allocator, other.m_capacity);
+			m_capacity = other.m_capacity;
+			m_used_count = other.m_used_count;
+			m_free_indices = other.m_free_indices;
+
+			// indices are visited in the same order both times, so the first copied_count indices hold the copies
+			size_t copied_count = 0;
+			details::scope_rollback rollback{ [this, &visit_live, &copied_count]()
+				{
+					visit_live([this, &copied_count](const uint32_t index)
+						{
+							if (copied_count == 0)
+								return;
+
+							--copied_count;
+							allocator_traits_t::destroy(m_allocator, m_values + index);
+						}
+					);
+				}
+			};
+
+			visit_live([this, &other, &copied_count](const uint32_t index)
+				{
+					allocator_traits_t::construct(m_allocator, m_values + index, other.m_values[index]);
+					++copied_count;
+				}
+			);
+			rollback.dismiss();
+		}
+		// destroy every live value and free the array
+		template <typename visit_live_t>
+		void clear(visit_live_t&& visit_live)
+		{
+			if constexpr (!std::is_trivially_destructible_v<value_t>)
+				visit_live([this](const uint32_t index) { allocator_traits_t::destroy(m_allocator, m_values + index); });
+
+			deallocate();
+			m_used_count = 0;
+			m_free_indices.clear();
+		}
+		// swap the values of two arrays, allocators that do not propagate must be equal
+		void swap(split_value_array& other)
+		{
+			std::swap(m_values, other.m_values);
+			std::swap(m_used_count, other.m_used_count);
+			std::swap(m_capacity, other.m_capacity);
+			std::swap(m_free_indices, other.m_free_indices);
+			if constexpr (allocator_traits_t::propagate_on_container_swap::value)
+				std::swap(m_allocator, other.m_allocator);
+		}
+
+		// number of values the array holds before it grows
+		inline size_t capacity() const { return m_capacity; }
+		// number of bytes allocated for values and freed indices
+		inline size_t get_allocated_bytes() const { return sizeof(value_t) * m_capacity + sizeof(uint32_t) * m_free_indices.capacity(); }
+	private:
+		// free the allocation, its values must already be destroyed or moved from
+		inline void deallocate()
+		{
+			if (m_values)
+				allocator_traits_t::deallocate(m_allocator, m_values, m_capacity);
+
+			m_values = nullptr;
+			m_capacity = 0;
+		}
+	private:
+		// indices are stored in 4 bytes
+		static constexpr const size_t s_max_capacity = 0xFFFF'FFFFull;
+
+		// the values, only indices that were created and not destroyed hold a live value
+		value_t* m_values = nullptr;
+		// number of indices handed out at least once
+		size_t m_used_count = 0;
+		// number of values the allocation holds
+		size_t m_capacity = 0;
+		// indices destroyed since they were handed out
+		std::vector<uint32_t> m_free_indices;
+		// allocator for the values
+		allocator_t m_allocator{};
+	};
+
+} // end namespace ::details
+
+// unordered hash map that keeps keys and values in separate arrays
+// the swiss table slots hold only the key and a 4 byte index into a value array, so probing and key compares never pull
+// value cache lines, and the value is only read on a hit. contains() and misses touch a fraction of the memory of the flat map
+// growth moves keys and indices, values move only when the value array itself grows, and never get rehashed
+// the cost is one more (dependent) load on a hit, so prefer the flat map when values are about as small as keys
+// values are not pointer stable, an insertion that grows the value array moves them (see node_unordered_hash_map)
+template <
+	typename K,
+	typename V,
+	typename Hash = hash::hasher<K>,
+	typename KeyEqual = hash::key_equal<K>,
+	typename Allocator = std::allocator<details::hash_map_pair<K, V>>,
+	bool StoreHash = false
+>
+class split_flat_unordered_hash_map
+{
+public:
+	using key_t = K;
+	using value_t = V;
+	using hasher_t = Hash;
+	using key_equal_t = KeyEqual;
+	using allocator_t = Allocator;
+	using reference_t = details::split_pair_reference<key_t, value_t>;
+	using const_reference_t = details::split_pair_reference<key_t, const value_t>;
+	using slot_t = details::hash_map_pair<key_t, details::split_value<value_t>>;
+	using slot_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<slot_t>;
+	using map_t = flat_unordered_hash_map<key_t, details::split_value<value_t>, hasher_t, key_equal_t, slot_allocator_t, StoreHash>;
+	using value_array_t = details::split_value_array<value_t, allocator_t>;
+public:
+	// iterator over the entries of the map, dereferences to a reference_t
+	class iterator
+	{
+	public:
+		// default constructor
+		iterator() = default;
+		// constructor that wraps an iterator of the underlying map
+		iterator(const typename map_t::iterator& it, value_array_t* values)
+			: m_it{ it }, m_values{ values }
+		{ }
+
+		// dereferencing operator
+		reference_t operator*() const { return reference_t{ (*m_it).key, (*m_values)[(*m_it).value_index] }; }
+
+		// equality comparison operator
+		bool operator==(const iterator& other) const { return m_it == other.m_it; }
+		// inequality comparison operator
+		bool operator!=(const iterator& other) const { return !(*this == other); }
+
+		// prefix increment operator
+		iterator& operator++()
+		{
+			++m_it;
+			return *this;
+		}
+	private:
+		// iterator of the underlying map
+		typename map_t::iterator m_it{};
+		// value array of the map
+		value_array_t* m_values = nullptr;
+	};
+
+	// const iterator over the entries of the map, dereferences to a const_reference_t
+	class citerator
+	{
+	public:
+		// default constructor
+		citerator() = default;
+		// constructor that wraps an iterator of the underlying map
+		citerator(const typename map_t::citerator& it, const value_array_t* values)
+			: m_it{ it }, m_values{ values }
+		{ }
+
+		// dereferencing operator
+		const_reference_t operator*() const { return const_reference_t{ (*m_it).key, (*m_values)[(*m_it).value_index] }; }
+
+		// equality comparison operator
+		bool operator==(const citerator& other) const { return m_it == other.m_it; }
+		// inequality comparison operator
+		bool operator!=(const citerator& other) const { return !(*this == other); }
+
+		// prefix increment operator
+		citerator& operator++()
+		{
+			++m_it;
+			return *this;
+		}
+	private:
+		// iterator of the underlying map
+		typename map_t::citerator m_it{};
+		// value array of the map
+		const value_array_t* m_values = nullptr;
+	};
+public:
+	// default constructor, allocates nothing until the first insertion
+	split_flat_unordered_hash_map() = default;
+	// constructor with a custom allocator
+	explicit split_flat_unordered_hash_map(const allocator_t& allocator)
+		: m_map{ slot_allocator_t{ allocator } }, m_values{ allocator }
+	{ }
+	// constructor with a custom hash, key equality function, and allocator
+	explicit split_flat_unordered_hash_map(const hasher_t& hasher, const key_equal_t& key_equal = key_equal_t{}, const allocator_t& allocator = allocator_t{})
+		: m_map{ hasher, key_equal, slot_allocator_t{ allocator } }, m_values{ allocator }
+	{ }
+	// copy constructor, values are copied to the same indices so the copied slots stay valid
+	split_flat_unordered_hash_map(const split_flat_unordered_hash_map& other);
+	// move constructor
+	split_flat_unordered_hash_map(split_flat_unordered_hash_map&& other) noexcept = default;
+	// destructor
+	~split_flat_unordered_hash_map() { m_values.clear(get_live_visitor()); }
+
+	// copy assign operator
+	split_flat_unordered_hash_map& operator=(const split_flat_unordered_hash_map& other);
+	// move assign operator
+	split_flat_unordered_hash_map& operator=(split_flat_unordered_hash_map&& other) noexcept;
+
+	// ========
+	// capacity
+	// ========
+
+	// check whether the map is empty
+	inline bool empty() const { return m_map.empty(); }
+	// returns the number of key-value pairs in the map
+	inline size_t size() const { return m_map.size(); }
+	// returns the number of slots before the map grows, 0 until the first insertion
+	inline size_t max_size() const { return m_map.max_size(); }
+	// returns the number of bytes allocated for the metadata and key buckets and the value array
+	inline size_t get_allocated_bytes() const { return m_map.get_allocated_bytes() + m_values.get_allocated_bytes(); }
+	// probing and occupancy statistics of the key bucket, see flat_unordered_hash_map::stats
+	// the allocated bytes include the value array
+	inline details::hash_map_stats stats() const
+	{
+		details::hash_map_stats result = m_map.stats();
+		result.allocated_bytes = get_allocated_bytes();
+		return result;
+	}
+	// zero the probing and rebuild counters
+	inline void reset_stats() { m_map.reset_stats(); }
+	// spread growth of the key bucket over later insertions and erasures, see flat_unordered_hash_map::set_incremental_rebuild
+	inline void set_incremental_rebuild(const size_t groups_per_operation) { m_map.set_incremental_rebuild(groups_per_operation); }
+	// returns a copy of the allocator used by the map
+	inline allocator_t get_allocator() const { return allocator_t{ m_map.get_allocator() }; }
+	// returns a copy of the hash function used by the map
+	inline hasher_t get_hasher() const { return m_map.get_hasher(); }
+	// returns a copy of the key equality function used by the map
+	inline key_equal_t get_key_equal() const { return m_map.get_key_equal(); }
+
+	// =========
+	// modifiers
+	// =========
+
+	// destroy every pair and free memory
+	void clear();
+	// insert a pair via key and value, *safely* fails if the key is already present
+	inline void insert(const key_t& key, const value_t& value) { try_emplace(key, value); }
+	// insert a pair via key and value, *safely* fails if the key is already present
+	inline void insert(key_t&& key, value_t&& value) { try_emplace(std::move(key), std::move(value)); }
+	// insert a pair, the value of an existing key is replaced
+	void emplace(key_t&& key, value_t&& value);
+	// construct a value in-place if the key does not exist, returns the value of the key either way
+	template <typename key_arg_t, typename... Args>
+	value_t& try_emplace(key_arg_t&& key, Args&&... args);
+	// erase a pair, its value index is reused by a later insertion
+	void erase(const key_t& key);
+	// swap the contents
+	void swap(split_flat_unordered_hash_map& other);
+	// reserve *more* slots for the keys and room for as many values
+	void reserve(const size_t new_size);
+
+	// ======
+	// lookup
+	// ======
+
+	// access a specific element with bounds checking
+	value_t& at(const key_t& key);
+	// access a specific element with bounds checking
+	const value_t& at(const key_t& key) const;
+	// access or insert (default construct) a specific element
+	inline value_t& operator[](const key_t& key) { return try_emplace(key); }
+	// finds the element with a certain key
+	inline iterator find(const key_t& key) { return iterator{ m_map.find(key), &m_values }; }
+	// finds the element with a certain key
+	inline citerator find(const key_t& key) const { return citerator{ m_map.find(key), &m_values }; }
+	// check if a key is contained within the map, only the key bucket is read
+	inline bool contains(const key_t& key) const { return m_map.contains(key); }
+	// check a batch of keys at once, out[i] is whether keys[i] is in the map, only the key bucket is read
+	inline void contains_many(const key_t* keys, const size_t count, bool* out) const { m_map.contains_many(keys, count, out); }
+
+	// =========
+	// iterators
+	// =========
+
+	// iterator pointing to the beginning of the map
+	inline iterator begin() { return iterator{ m_map.begin(), &m_values }; }
+	// iterator pointing to the end of the map
+	inline iterator end() { return iterator{ m_map.end(), &m_values }; }
+	// const iterator pointing to the beginning of the map
+	inline citerator begin() const { return cbegin(); }
+	// const iterator pointing to the end of the map
+	inline citerator end() const { return cend(); }
+	// const iterator pointing to the beginning of the map
+	inline citerator cbegin() const { return citerator{ m_map.cbegin(), &m_values }; }
+	// const iterator pointing to the end of the map
+	inline citerator cend() const { return citerator{ m_map.cend(), &m_values }; }
+	// call function(reference_t) on every pair in the map, faster than iterating since whole metadata groups are scanned at once
+	template <typename function_t>
+	inline void for_each(function_t&& function) { m_map.for_each([this, &function](const slot_t& slot) { function(reference_t{ slot.key, m_values[slot.value_index] }); }); }
+	// call function(const_reference_t) on every pair in the map
+	template <typename function_t>
+	inline void for_each(function_t&& function) const { m_map.for_each([this, &function](const slot_t& slot) { function(const_reference_t{ slot.key, m_values[slot.value_index] }); }); }
+private:
+	// visitor over the value indices of every slot, for the value array
+	inline auto get_live_visitor() const
+	{
+		return [this](auto&& function) { m_map.for_each([&function](const slot_t& slot) { function(slot.value_index); }); };
+	}
+	// make room for one more value, only called once the key is known to be missing so existing values never move
+	// a prepared slot is not marked occupied before construct_pair_at, so growing here only visits constructed slots
+	inline void prepare_value()
+	{
+		if (m_values.is_full())
+			m_values.grow(std::max(m_values.capacity() * 2, s_min_value_capacity), get_live_visitor());
+	}
+private:
+	// smallest allocation of the value array
+	static constexpr const size_t s_min_value_capacity = 8ull;
+
+	// swiss table of keys and value indices
+	map_t m_map{};
+	// values of every slot, addressed by slot_t::value_index
+	value_array_t m_values{};
+};
+
+// ============================
+// start implementation details
+// ============================
+
+// copy constructor
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::split_flat_unordered_hash_map(const split_flat_unordered_hash_map& other)
+	: m_map{ other.m_map },
+	m_values{ std::allocator_traits<allocator_t>::select_on_container_copy_construction(other.get_allocator()) }
+{
+	m_values.copy_from(other.m_values, get_live_visitor());
+}
+
+// copy assign operator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>& split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::operator=(const split_flat_unordered_hash_map& other)
+{
+	if (this != &other)
+	{
+		split_flat_unordered_hash_map copy{ other };
+		swap(copy);
+	}
+
+	return *this;
+}
+
+// move assign operator
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>& split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::operator=(split_flat_unordered_hash_map&& other) noexcept
+{
+	if (this != &other)
+	{
+		clear();
+		swap(other);
+	}
+
+	return *this;
+}
+
+// destroy every value, then free both arrays
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::clear()
+{
+	m_values.clear(get_live_visitor());
+	m_map.clear();
+}
+
+// insert or replace a pair
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::emplace(key_t&& key, value_t&& value)
+{
+	const typename map_t::insert_slot_t slot = m_map.find_or_prepare_insert(key);
+	if (slot.found)
+	{
+		m_values[m_map.m_bucket[slot.index].value_index] = std::move(value);
+		return;
+	}
+
+	prepare_value();
+	m_map.construct_pair_at(slot.index, slot.hash_value, std::move(key), m_values.create(std::move(value)));
+	++m_map.m_element_count;
+}
+
+// construct the value of a missing key in-place
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+template <typename key_arg_t, typename... Args>
+V& split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::try_emplace(key_arg_t&& key, Args&&... args)
+{
+	const typename map_t::insert_slot_t slot = m_map.find_or_prepare_insert(key);
+	if (slot.found)
+		return m_values[m_map.m_bucket[slot.index].value_index];
+
+	prepare_value();
+	const uint32_t value_index = m_values.create(std::forward<Args>(args)...);
+	m_map.construct_pair_at(slot.index, slot.hash_value, std::forward<key_arg_t>(key), value_index);
+	++m_map.m_element_count;
+	return m_values[value_index];
+}
+
+// erase a pair
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::erase(const key_t& key)
+{
+	if (m_map.empty())
+		return;
+
+	const typename map_t::hash_t hash_value = m_map.hash_key(key);
+	m_map.continue_incremental_rebuild(key, hash_value);
+
+	const size_t index = m_map.find_index_of(map_t::metadata_t::get_h1_hash(hash_value), map_t::metadata_t::get_h2_hash(hash_value), key);
+	if (!m_map.is_slot_occupied(m_map.m_metadata_bucket[index]))
+	{
+#ifdef KB_DEBUG
+		KB_CORE_ASSERT(false, "key does not exist in map!");
+#endif
+		return;
+	}
+
+	const uint32_t value_index = m_map.m_bucket[index].value_index;
+	m_map.erase_at(index);
+	m_values.destroy(value_index);
+}
+
+// swap the contents
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::swap(split_flat_unordered_hash_map& other)
+{
+	m_map.swap(other.m_map);
+	m_values.swap(other.m_values);
+}
+
+// reserve key slots, and values for as many entries as the slots can hold before growing
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+void split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::reserve(const size_t new_size)
+{
+	m_map.reserve(new_size);
+
+	if (new_size > m_values.capacity())
+		m_values.grow(new_size, get_live_visitor());
+}
+
+// access a specific element with bounds checking
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+V& split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::at(const K& key)
+{
+	const slot_t* slot = m_map.find_pair(key);
+
+	KB_CORE_ASSERT(slot, "key does not exist in the map!");
+
+	return m_values[slot->value_index];
+}
+
+// access a specific element with bounds checking
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator, bool StoreHash>
+const V& split_flat_unordered_hash_map<K, V, Hash, KeyEqual, Allocator, StoreHash>::at(const K& key) const
+{
+	const slot_t* slot = m_map.find_pair(key);
+
+	KB_CORE_ASSERT(slot, "key does not exist in the map!");
+
+	return m_values[slot->value_index];
+}
+
+// ==========================
+// end implementation details
+// ==========================
+
+} // end namespace Kablunk::util::container
+
+#endif